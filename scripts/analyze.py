@@ -28,7 +28,8 @@ def commands():
 @click.option("--target", "-t", default=LINUX_ROOT)
 @click.option("--file", "-f", default=None)
 @click.option("--measure", "-m", is_flag=True)
-def linux(target, file, measure):
+@click.option("--analysis-only", "-a", is_flag=True)
+def linux(target, file, measure, analysis_only):
     print(f"Start running analyzer")
     tmplog = os.path.join(LOG_DIR, "tmplog")
     current = datetime.datetime.now().strftime('%Y_%m_%d_%H:%M')
@@ -45,6 +46,9 @@ def linux(target, file, measure):
         if measure:
             compiler_flags += ["-mllvm", "-measure"]
 
+        if analysis_only:
+            compiler_flags += ["-mllvm", "-fitx-analysis-only"]
+
         if file:
             target_file = os.path.join(target, file)
             if os.path.exists(target_file):
@@ -69,7 +73,7 @@ def linux(target, file, measure):
     for logfile in logfiles:
         result = subprocess.run([
             'awk',
-            'tolower($0) ~ /error/ || $0 ~ /LOG/ || $0 ~ /WARN/',
+            'tolower($0) ~ /error/ || $0 ~ /LOG/ || $0 ~ /WARN/ || $0 ~ /ABORTED/',
             logfile
         ], stdout=subprocess.PIPE)
         log_output += utils.remove_redundant_log(result.stdout.decode('utf-8'))
@@ -101,27 +105,49 @@ def linux(target, file, measure):
     print(f"Logged to file {log}")
 
 
+def run_test(target_file, mllvm_flags=()):
+    additional_flags = ["-Xclang", "-load", "-Xclang", DETECTOR_PATH]
+    for flag in mllvm_flags:
+        additional_flags += ["-mllvm", flag]
+
+    # compile_command = ["clang", target, "-o", "/dev/null"
+    compile_command = ["clang-14", target_file, "-o", "/dev/null",
+                       "-flegacy-pass-manager"
+                    ] + utils.compilation_flags(additional_flags)
+    result = subprocess.run(compile_command, stderr=subprocess.PIPE)
+    return result.stderr.decode('utf-8')
+
+
+# The report lines the awk filters below keep, in a stable order
+def report_lines(output):
+    return sorted(line for line in output.split('\n')
+                  if 'error' in line.lower() or 'LOG' in line or
+                  'WARN' in line or 'ABORTED' in line)
+
+
 @commands.command()
 @click.argument("target", type=click.Path(exists=True))
-def test(target):
+@click.option("--compare", "-c", multiple=True,
+              help="Run every test again with this -mllvm flag and fail if "
+                   "the reports differ")
+def test(target, compare):
     print(f"Running test on {target}")
     target_files = utils.get_files(Path(target))
-    additional_flags = ["-Xclang", "-load", "-Xclang", DETECTOR_PATH]
 
     tmplog = os.path.join(LOG_DIR, "tmplog")
     current = datetime.datetime.now().strftime('%Y_%m_%d_%H:%M')
     log = os.path.join(LOG_DIR, f"{current}.log")
 
     print(f"Found {len(target_files)} tests")
+    mismatches = []
     with open(tmplog, 'w+') as f:
         for target_file in target_files:
             print(f"[Running] {target_file}\r", end="")
-            # compile_command = ["clang", target, "-o", "/dev/null"
-            compile_command = ["clang-14", target_file, "-o", "/dev/null",
-                               "-flegacy-pass-manager"
-                            ] + utils.compilation_flags(additional_flags)
-            result = subprocess.run(compile_command, stderr=subprocess.PIPE)
-            f.write(result.stderr.decode('utf-8'))
+            output = run_test(target_file)
+            f.write(output)
+            if compare and report_lines(output) != report_lines(
+                    run_test(target_file, compare)):
+                mismatches.append(target_file)
 
     log_output = ''
     logfiles = [tmplog]
@@ -129,7 +155,7 @@ def test(target):
     for logfile in logfiles:
         result = subprocess.run([
             'awk',
-            'tolower($0) ~ /error/ || $0 ~ /LOG/ || $0 ~ /WARN/',
+            'tolower($0) ~ /error/ || $0 ~ /LOG/ || $0 ~ /WARN/ || $0 ~ /ABORTED/',
             logfile
         ], stdout=subprocess.PIPE)
         log_output += utils.remove_redundant_log(result.stdout.decode('utf-8'))
@@ -146,6 +172,15 @@ def test(target):
 
     print(f"\nLogged to file {log}")
 
+    if compare:
+        flags = " ".join(compare)
+        for target_file in mismatches:
+            print(f"[Mismatch] {target_file} with {flags}")
+        print(f"{len(target_files) - len(mismatches)}/{len(target_files)} "
+              f"tests report the same with {flags}")
+        if mismatches:
+            raise SystemExit(1)
+
 
 if __name__ == "__main__":
     commands()
@@ -0,0 +1,38 @@
+#include "core/AnalysisContext.hpp"
+
+#include "core/Function.hpp"
+#include "core/SFG/Converter.hpp"
+
+namespace framework {
+static thread_local AnalysisContext* current_context = nullptr;
+
+AnalysisContext::AnalysisContext()
+    : converter_(new Converter()) {}
+
+AnalysisContext::~AnalysisContext() { clear(); }
+
+AnalysisContext& AnalysisContext::Current() {
+  if (current_context) return *current_context;
+  // Left alive on exit, as the llvm passes may still use it
+  static AnalysisContext* process_context = new AnalysisContext();
+  return *process_context;
+}
+
+AnalysisContext::Scope::Scope(AnalysisContext& context)
+    : previous_(current_context) {
+  current_context = &context;
+}
+
+AnalysisContext::Scope::~Scope() { current_context = previous_; }
+
+void AnalysisContext::clear() {
+  // The callers and the called functions hold each other
+  for (auto& function : created_functions_) function.second->dropReferences();
+
+  framework_ir_.clear();
+  snapshots_.clear();
+  created_functions_.clear();
+  converter_->clear();
+  path_stats_ = Value::AccessPathStats();
+}
+}  // namespace framework
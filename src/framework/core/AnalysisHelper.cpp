@@ -1,5 +1,6 @@
 #include "core/AnalysisHelper.hpp"
 
+#include "core/Function.hpp"
 #include "core/Utils.hpp"
 #include "core/Value.hpp"
 #include "llvm/IR/DataLayout.h"
@@ -101,16 +102,9 @@ bool isInPredecessor(std::shared_ptr<framework::BasicBlock> target,
                      std::shared_ptr<framework::BasicBlock> block, int depth) {
   if (depth < 0) return false;
 
-  for (auto pred_ref : block->Predecessors()) {
-    auto pred = pred_ref.lock();
-    if (!pred)
-      continue;
-
-    if (pred == target || isInPredecessor(target, pred, depth - 1))
-      return true;
-  }
-
-  return false;
+  auto function = block->Parent().lock();
+  if (!function) return false;
+  return function->BlockReachability().isPredecessor(target, block, depth + 1);
 }
 
 }  // namespace framework
@@ -1,5 +1,7 @@
 #include "core/BasicBlock.hpp"
 
+#include <algorithm>
+
 #include "core/Function.hpp"
 #include "core/Instruction.hpp"
 #include "core/Instructions.hpp"
@@ -26,32 +28,14 @@ bool BasicBlock::operator<(const framework::BasicBlock& basic_block) {
   return llvm_basic_block_ < basic_block.llvm_basic_block_;
 }
 
-bool operator<(const std::weak_ptr<framework::BasicBlock> source_block,
-               const std::weak_ptr<framework::BasicBlock> target_block) {
-  auto source = source_block.lock();
-  auto target = target_block.lock();
-
-  return source->llvm_basic_block_ < target->llvm_basic_block_;
-}
-
 bool operator==(const std::shared_ptr<framework::BasicBlock> basic_block,
                 const llvm::BasicBlock* llvm_block) {
   return basic_block->llvm_basic_block_ == llvm_block;
 }
 
-void BasicBlock::addSuccessor(std::shared_ptr<framework::BasicBlock> block) {
-  successors_.insert(block);
-}
-
-void BasicBlock::addPredecessor(std::shared_ptr<framework::BasicBlock> block) {
-  predecessors_.insert(block);
-}
-
 bool BasicBlock::isInPredecessor(std::shared_ptr<framework::BasicBlock> block) {
-  return std::find_if(predecessors_.begin(), predecessors_.end(),
-                      [block](std::weak_ptr<framework::BasicBlock> pred) {
-                        return pred.lock() == block;
-                      }) != predecessors_.end();
+  return std::find(predecessors_.begin(), predecessors_.end(), block) !=
+         predecessors_.end();
 }
 
 void BasicBlock::addInstruction(std::shared_ptr<framework::Instruction> inst) {
@@ -1,5 +1,6 @@
 #include "core/Function.hpp"
 
+#include "core/AnalysisContext.hpp"
 #include "core/BasicBlock.hpp"
 #include "core/Instructions.hpp"
 #include "core/Utils.hpp"
@@ -9,13 +10,14 @@
 namespace framework {
 std::shared_ptr<framework::Function> Function::createManagedFunction(
     llvm::Function* function, std::unique_ptr<llvm::LoopInfo> loop_info) {
-  if (created_functions_.find(function) == created_functions_.end())
-    created_functions_[function] =
+  auto& created_functions = AnalysisContext::Current().CreatedFunctions();
+  if (created_functions.find(function) == created_functions.end())
+    created_functions[function] =
         std::make_shared<framework::Function>(function, std::move(loop_info));
 
-  if (!created_functions_[function]->hasLoopInfo() && loop_info)
-    created_functions_[function]->setLoopInfo(std::move(loop_info));
-  return created_functions_[function];
+  if (!created_functions[function]->hasLoopInfo() && loop_info)
+    created_functions[function]->setLoopInfo(std::move(loop_info));
+  return created_functions[function];
 }
 
 bool Function::IsDebugValueFunction(
@@ -62,19 +64,47 @@ Function::Function(llvm::Function* function,
       return_value_(nullptr),
       protected_refcount_value_(nullptr) {}
 
-std::shared_ptr<framework::BasicBlock> Function::getBasicBlock(
-    llvm::BasicBlock* basic_block) {
-  auto block =
-      std::find(basic_blocks_.begin(), basic_blocks_.end(), basic_block);
-  if (block != basic_blocks_.end()) return *block;
+uint32_t Function::blockId(llvm::BasicBlock* basic_block) {
+  // The ids follow the order of the blocks in the llvm function
+  if (block_ids_.empty()) {
+    uint32_t id = 0;
+    for (auto& llvm_block : *llvm_function_) block_ids_[&llvm_block] = id++;
+    blocks_.resize(id);
+  }
 
-  auto framework_block = std::make_shared<framework::BasicBlock>(basic_block);
-  basic_blocks_.insert(framework_block);
+  auto found = block_ids_.find(basic_block);
+  if (found == block_ids_.end()) {
+    found = block_ids_.insert({basic_block, blocks_.size()}).first;
+    blocks_.emplace_back();
+  }
+  return found->second;
+}
 
-  framework_block->collectPassthroughBlock();
+std::shared_ptr<framework::BasicBlock> Function::createBasicBlock(
+    llvm::BasicBlock* basic_block, uint32_t id) {
+  auto framework_block = std::make_shared<framework::BasicBlock>(basic_block);
+  framework_block->setId(id);
+  blocks_[id] = framework_block;
 
   if (basic_block == &llvm_function_->getEntryBlock())
     init_block_ = framework_block;
+  return framework_block;
+}
+
+std::shared_ptr<framework::BasicBlock> Function::addBasicBlock(
+    llvm::BasicBlock* basic_block) {
+  uint32_t id = blockId(basic_block);
+  if (blocks_[id]) return blocks_[id];
+  return createBasicBlock(basic_block, id);
+}
+
+std::shared_ptr<framework::BasicBlock> Function::getBasicBlock(
+    llvm::BasicBlock* basic_block) {
+  uint32_t id = blockId(basic_block);
+  if (blocks_[id]) return blocks_[id];
+
+  auto framework_block = createBasicBlock(basic_block, id);
+  framework_block->collectPassthroughBlock();
 
   llvm::Loop* loop =
       loop_info_.get() ? loop_info_->getLoopFor(basic_block) : nullptr;
@@ -90,7 +120,7 @@ std::shared_ptr<framework::BasicBlock> Function::getBasicBlock(
   // Generate Predecessor Information
   for (auto block : llvm::successors(basic_block)) {
     std::shared_ptr<framework::BasicBlock> successor = getBasicBlock(block);
-    framework_block->addSuccessor(successor);
+    successor_edges_.push_back({id, successor->Id()});
 
     if (successor->Line() <= framework_block->Line())
       setLoopBackBlock(true);
@@ -105,14 +135,66 @@ std::shared_ptr<framework::BasicBlock> Function::getBasicBlock(
         loop->getBlocksSet().find(block) != loop->getBlocksSet().end())
       continue;
 
-    framework_block->addPredecessor(getBasicBlock(block));
+    predecessor_edges_.push_back({id, getBasicBlock(block)->Id()});
   }
 
   return framework_block;
 }
 
+// Counting sort of the edges by source, each row sorted and without
+// duplicates, as the sets of blocks they replace
+static void buildCSR(std::vector<std::pair<uint32_t, uint32_t>>& edges,
+                     size_t block_num, std::vector<uint32_t>& offsets,
+                     std::vector<uint32_t>& ids) {
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+  offsets.assign(block_num + 1, 0);
+  ids.clear();
+  ids.reserve(edges.size());
+  for (auto& edge : edges) {
+    offsets[edge.first + 1]++;
+    ids.push_back(edge.second);
+  }
+  for (size_t id = 0; id < block_num; id++) offsets[id + 1] += offsets[id];
+}
+
+void Function::setEdges(
+    std::vector<std::pair<uint32_t, uint32_t>> successor_edges,
+    std::vector<std::pair<uint32_t, uint32_t>> predecessor_edges) {
+  successor_edges_ = std::move(successor_edges);
+  predecessor_edges_ = std::move(predecessor_edges);
+}
+
+void Function::buildCFG() {
+  reachability_.reset();
+  buildCSR(successor_edges_, blocks_.size(), successor_offsets_,
+           successor_ids_);
+  buildCSR(predecessor_edges_, blocks_.size(), predecessor_offsets_,
+           predecessor_ids_);
+
+  for (uint32_t id = 0; id < blocks_.size(); id++) {
+    if (!blocks_[id]) continue;
+    blocks_[id]->setEdges(
+        BlockRange(&blocks_, &successor_ids_, successor_offsets_[id],
+                   successor_offsets_[id + 1]),
+        BlockRange(&blocks_, &predecessor_ids_, predecessor_offsets_[id],
+                   predecessor_offsets_[id + 1]));
+  }
+}
+
+framework::Reachability& Function::BlockReachability() {
+  if (!reachability_)
+    reachability_ = std::make_unique<framework::Reachability>(
+        predecessor_offsets_, predecessor_ids_);
+  return *reachability_;
+}
+
 bool Function::isLoopBlock(std::shared_ptr<framework::BasicBlock> block) {
-  return loop_info_ && loop_info_->getLoopFor(block->LLVMBasicBlock());
+  if (loop_info_) return loop_info_->getLoopFor(block->LLVMBasicBlock());
+  return block->Id() >= 0 &&
+         static_cast<size_t>(block->Id()) < loop_blocks_.size() &&
+         loop_blocks_[block->Id()];
 }
 
 void Function::setReturnValue(std::shared_ptr<framework::Value> value) {
@@ -160,6 +242,25 @@ bool Function::ContainsLoopBackBlock() {
   return contains_loop_back_blocks_;
 }
 
-std::map<llvm::Function*, std::shared_ptr<framework::Function>>
-    framework::Function::created_functions_;
+std::map<llvm::Function*, std::shared_ptr<framework::Function>>&
+Function::CreatedFunctions() {
+  return AnalysisContext::Current().CreatedFunctions();
+}
+
+void Function::clearManagedFunctions() {
+  AnalysisContext::Current().CreatedFunctions().clear();
+}
+
+void Function::dropReferences() {
+  caller_functions_.clear();
+  return_assignment_.clear();
+  return_value_.reset();
+  protected_refcount_value_.reset();
+  last_refcount_call_.reset();
+  init_block_.reset();
+  return_block_.reset();
+  reachability_.reset();
+  blocks_.clear();
+  block_ids_.clear();
+}
 }  // namespace framework
@@ -77,10 +77,15 @@ Instruction::Instruction(std::shared_ptr<Instruction> instruction,
   line_ = instruction->Line();
   column_ = instruction->Column();
   parent_ = instruction->Parent();
+  sequence_function_ = instruction->SequenceFunction();
+  sequence_ = instruction->Sequence();
 }
 
 bool Instruction::operator<=(const framework::Instruction& instruction) const {
   if (llvm_instruction_ == instruction.llvm_instruction_) return true;
+  if (sequence_function_ &&
+      sequence_function_ == instruction.sequence_function_)
+    return sequence_ <= instruction.sequence_;
 
   return module_ == instruction.module_ && line_ == instruction.line_ ||
          *this < instruction;
@@ -99,6 +104,10 @@ bool Instruction::operator<(llvm::Instruction* instruction) const {
 }
 
 bool Instruction::operator<(const framework::Instruction& instruction) const {
+  if (sequence_function_ &&
+      sequence_function_ == instruction.sequence_function_)
+    return sequence_ < instruction.sequence_;
+
   if (module_ != instruction.module_) return module_ < instruction.module_;
 
   if (line_ != instruction.line_) return line_ < instruction.line_;
@@ -197,6 +197,17 @@ void BranchInst::setTransitionNode(
   nodes_[code].push_back(block);
 }
 
+const EdgeFacts* BranchInst::getEdgeFacts(
+    const std::shared_ptr<framework::BasicBlock>& successor) const {
+  auto facts = edge_facts_.find(successor.get());
+  return facts != edge_facts_.end() ? &facts->second : nullptr;
+}
+
+void BranchInst::setEdgeFacts(std::shared_ptr<framework::BasicBlock> successor,
+                              const EdgeFacts& facts) {
+  edge_facts_[successor.get()] = facts;
+}
+
 bool BranchInst::isInOperand(std::shared_ptr<framework::Value> value) {
   if (!condition_instruction_) return false;
 
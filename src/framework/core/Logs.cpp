@@ -49,23 +49,67 @@ LoggingClient::LoggingClient() {
   buffer_.reserve(ReadEndPoint::kBufferSize * 10);
 }
 
+LoggingClient::LoggingClient(std::string& sink) : sink_(&sink) {
+  buffer_.reserve(ReadEndPoint::kBufferSize * 10);
+}
+
 void LoggingClient::log(const std::string& log) {
   buffer_.append(log);
 }
 
+void LoggingClient::report(const Report& report) {
+  if (report_callback_)
+    report_callback_(report);
+  else
+    log(report.text);
+}
+
 void LoggingClient::flush() {
   WriteEndPoint& write_point = end_points_.write;
-  if (write_point.valid())
+  if (sink_)
+    sink_->append(buffer_);
+  else if (write_point.valid())
     write_point.write_log(buffer_);
   else
     llvm::errs() << buffer_;
   buffer_.clear();
 }
 
+std::string LoggingClient::takeBuffer() {
+  std::string buffer;
+  buffer.swap(buffer_);
+  return buffer;
+}
+
 void LoggingClient::printLog() {
   if (end_points_.read.valid()) llvm::errs() << end_points_.read.readLog();
 }
 
+// "<key size> <text size>\n" followed by the key and the text
+std::string LoggingClient::encodeReport(const Report& report) {
+  return std::to_string(report.key.size()) + " " +
+         std::to_string(report.text.size()) + "\n" + report.key + report.text;
+}
+
+std::vector<LoggingClient::Report> LoggingClient::decodeReports(
+    llvm::StringRef records) {
+  std::vector<Report> reports;
+  while (!records.empty()) {
+    auto header = records.split('\n');
+    auto sizes = header.first.split(' ');
+    size_t key_size = 0, text_size = 0;
+    if (sizes.first.getAsInteger(10, key_size) ||
+        sizes.second.getAsInteger(10, text_size) ||
+        header.second.size() < key_size + text_size)
+      break;
+
+    reports.push_back({header.second.substr(0, key_size).str(),
+                       header.second.substr(key_size, text_size).str()});
+    records = header.second.drop_front(key_size + text_size);
+  }
+  return reports;
+}
+
 llvm::raw_ostream& operator<<(llvm::raw_ostream& ostream,
                               framework::LoggingClient& client) {
   if (client.end_points_.read.valid())
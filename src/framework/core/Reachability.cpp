@@ -0,0 +1,50 @@
+#include "core/Reachability.hpp"
+
+#include <algorithm>
+
+namespace framework {
+Reachability::Reachability(const std::vector<uint32_t>& predecessor_offsets,
+                           const std::vector<uint32_t>& predecessor_ids)
+    : offsets_(predecessor_offsets), ids_(predecessor_ids) {
+  rows_.resize(offsets_.empty() ? 0 : offsets_.size() - 1);
+}
+
+uint16_t Reachability::Distance(uint32_t target, uint32_t block) {
+  if (block >= rows_.size() || target >= rows_.size()) return kUnreachable;
+  return Row(block)[target];
+}
+
+bool Reachability::isPredecessor(std::shared_ptr<framework::BasicBlock> target,
+                                 std::shared_ptr<framework::BasicBlock> block,
+                                 unsigned steps) {
+  if (!target || !block || target->Id() == BasicBlock::kNoId ||
+      block->Id() == BasicBlock::kNoId)
+    return false;
+  return isPredecessor(target->Id(), block->Id(), steps);
+}
+
+// The walk starts from the predecessors rather than the block, so the block
+// itself is only reached through a cycle. It runs until every ancestor is
+// found, however far.
+const std::vector<uint16_t>& Reachability::Row(uint32_t block) {
+  auto& row = rows_[block];
+  if (!row.empty()) return row;
+
+  row.assign(rows_.size(), kUnreachable);
+  std::vector<uint32_t> frontier = {block};
+  std::vector<uint32_t> next;
+  for (unsigned distance = 1; !frontier.empty(); distance++) {
+    next.clear();
+    for (auto id : frontier) {
+      for (auto edge = offsets_[id]; edge < offsets_[id + 1]; edge++) {
+        auto pred = ids_[edge];
+        if (row[pred] != kUnreachable) continue;
+        row[pred] = std::min<unsigned>(distance, kFarthest);
+        next.push_back(pred);
+      }
+    }
+    frontier.swap(next);
+  }
+  return row;
+}
+}  // namespace framework
@@ -1,5 +1,6 @@
 #include "core/SFG/Converter.hpp"
 
+#include "core/AnalysisContext.hpp"
 #include "core/AnalysisHelper.hpp"
 #include "core/Casting.hpp"
 #include "core/Instruction.hpp"
@@ -13,9 +14,7 @@
 namespace framework {
 
 Converter& Converter::GetInstance() {
-  // We use static local variable in order to achieve singleton here
-  static Converter* converter = new Converter();
-  return *converter;
+  return AnalysisContext::Current().getConverter();
 }
 
 struct Converter::ValueSignature Converter::GetSignitureFromDefinition(
@@ -165,6 +164,7 @@ struct Converter::ValueSignature Converter::GetSignitureFromDefinition(
 
   signature.fields = UpdateFields(
       std::vector<Value::Fields>({Value::Fields(value->getType())}));
+  Value::LimitFields(signature.fields);
 
   return signature;
 }
@@ -227,7 +227,6 @@ std::shared_ptr<framework::Value> Converter::ConvertValue(
 
 void Converter::manageValue(llvm::Value* value,
                             std::shared_ptr<framework::Value> framework_value) {
-  ManagedValues::GetInstance().addValue(framework_value);
   managed_values_[value].push_back(framework_value);
 }
 
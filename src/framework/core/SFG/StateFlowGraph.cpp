@@ -0,0 +1,107 @@
+#include "core/SFG/StateFlowGraph.hpp"
+
+#include "core/Casting.hpp"
+#include "core/Instructions.hpp"
+#include "core/Value.hpp"
+#include "llvm/IR/Instruction.h"
+
+namespace framework {
+StateFlowGraph::StateFlowGraph(std::shared_ptr<framework::Function> function,
+                               bool track_loads) {
+  // The successors of a pass-through block take the states of the
+  // predecessors it selects for them, so those keep their states
+  std::set<std::shared_ptr<framework::BasicBlock>> pass_through_sources;
+  for (auto& block : function->OrderedBasicBlocks()) {
+    for (auto& pass_through : block->PassthroughBlocks()) {
+      for (auto& source : pass_through.second) {
+        if (auto source_block = source.lock())
+          pass_through_sources.insert(source_block);
+      }
+    }
+  }
+
+  auto return_block = function->ReturnBlock();
+  for (auto& block : function->OrderedBasicBlocks()) {
+    bool node = block == function->InitBlock() || block == return_block ||
+                pass_through_sources.count(block) ||
+                changesStates(block, track_loads);
+
+    // The return values are read from the predecessors of the return block,
+    // and the checks of a branch apply on entering its successors
+    for (auto& successor : block->Successors()) {
+      if (successor == return_block &&
+          return_block->Instructions().empty())
+        node = true;
+    }
+    for (auto& pred : block->Predecessors()) {
+      if (pred->isCleanupBlock() || branchChangesStates(pred))
+        node = true;
+    }
+
+    if (!node) continue;
+    nodes_.push_back(block);
+    node_set_.insert(block);
+  }
+
+  for (auto& node : nodes_) collectPredecessors(node);
+}
+
+bool StateFlowGraph::branchChangesStates(
+    std::shared_ptr<framework::BasicBlock> block) {
+  auto branch_inst = block->getBranchInst();
+  if (!branch_inst) return false;
+
+  // Null checks and checks of a returned value
+  auto& facts = branch_inst->Facts();
+  return facts.error_path || facts.null_operand || !facts.calls.empty();
+}
+
+bool StateFlowGraph::changesStates(std::shared_ptr<framework::BasicBlock> block,
+                                   bool track_loads) {
+  if (block->isCleanupBlock() || !block->DeadValues().empty() ||
+      branchChangesStates(block))
+    return true;
+
+  for (auto& inst : block->Instructions()) {
+    switch (inst->Opcode()) {
+      case llvm::Instruction::Call: {
+        auto function =
+            std::static_pointer_cast<framework::CallInst>(inst)
+                ->CalledFunction();
+        if (!function || !function->isDebugFunction() ||
+            Function::IsDebugDeclareFunction(function))
+          return true;
+        break;
+      }
+      case llvm::Instruction::Store:
+        return true;
+      case llvm::Instruction::Load:
+        if (track_loads) return true;
+        break;
+      default:
+        break;
+    }
+  }
+  return false;
+}
+
+// Walk back from the node through the blocks that are not nodes, up to the
+// nearest nodes
+void StateFlowGraph::collectPredecessors(
+    std::shared_ptr<framework::BasicBlock> node) {
+  auto& edges = predecessors_[node];
+  std::set<std::shared_ptr<framework::BasicBlock>> visited = {node};
+  std::vector<std::shared_ptr<framework::BasicBlock>> stack = {node};
+  while (!stack.empty()) {
+    auto block = stack.back();
+    stack.pop_back();
+    for (auto& pred : block->Predecessors()) {
+      if (isNode(pred)) {
+        edges.push_back({pred, block});
+        continue;
+      }
+      if (visited.insert(pred).second) stack.push_back(pred);
+    }
+  }
+}
+}  // namespace framework
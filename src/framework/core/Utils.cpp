@@ -153,6 +153,14 @@ void generateError(llvm::raw_ostream& stream, framework::Instruction* Inst,
   stream << *value << "\n";
 }
 
+std::string reportKey(framework::Instruction* inst, const std::string& bug,
+                      framework::Value* value) {
+  std::string key;
+  llvm::raw_string_ostream key_stream(key);
+  key_stream << getDebugInfo(inst) << bug << " " << *value;
+  return key_stream.str();
+}
+
 void generateLog(llvm::raw_ostream& stream, framework::Instruction* Inst,
                  std::string warn) {
   stream << "  [LOG] ";
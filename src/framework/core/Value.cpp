@@ -35,20 +35,52 @@
 #include <string>
 #include <vector>
 
+#include "core/AnalysisContext.hpp"
 #include "core/AnalysisHelper.hpp"
 #include "core/Casting.hpp"
 #include "core/Instructions.hpp"
 #include "core/SFG/Converter.hpp"
 #include "core/Utils.hpp"
 #include "core/Value.hpp"
+#include "llvm/Support/CommandLine.h"
+
+static llvm::cl::opt<unsigned> AccessPathDepthLimit(
+    "fitx-access-path-depth",
+    llvm::cl::desc("Fields kept in the access path of a value, the deeper "
+                   "ones are summarized (0: unlimited)"),
+    llvm::cl::init(8));
 
 namespace framework {
+bool Value::LimitFields(FieldList& fields) {
+  auto& access_path_stats = AnalysisContext::Current().PathStats();
+  access_path_stats.paths++;
+  if (!AccessPathDepthLimit || fields.size() <= AccessPathDepthLimit)
+    return false;
+
+  // Already summarized at this depth
+  if (fields.size() == AccessPathDepthLimit + 1 &&
+      fields.back().field == kSummarizedFields)
+    return false;
+
+  fields.resize(AccessPathDepthLimit + 1, Fields(nullptr));
+  fields.back().field = kSummarizedFields;
+  access_path_stats.truncated++;
+  return true;
+}
+
+const Value::AccessPathStats& Value::PathStats() {
+  return AnalysisContext::Current().PathStats();
+}
+
+unsigned Value::AccessPathDepth() { return AccessPathDepthLimit; }
+
 Value::Value(llvm::Value* value, std::vector<Fields> fields,
              long array_element_num)
     : value_(value),
       fields_(fields),
       array_element_num_(array_element_num),
       is_global_var_(llvm::isa<llvm::GlobalValue>(value)),
+      is_return_value_(false),
       value_type_(value->getValueID()) {}
 
 Value::Value(std::shared_ptr<framework::Value> value,
@@ -65,6 +97,7 @@ Value::Value(const Value& value)
       fields_(value.fields_),
       array_element_num_(value.array_element_num_),
       is_global_var_(value.is_global_var_),
+      is_return_value_(value.is_return_value_),
       value_type_(value.getValueID()) {}
 
 Value::Value(std::shared_ptr<Value> value) {
@@ -108,6 +141,7 @@ std::shared_ptr<Value> Value ::CreateAppend(std::shared_ptr<Value> src,
   auto new_fields =
       std::vector<Fields>(src->GetFields().begin(), source_back + 1);
   new_fields.insert(new_fields.end(), target_front, target->GetFields().end());
+  LimitFields(new_fields);
 
   int array_element_num =
       std::max(target->ArrayElementNum(), src->ArrayElementNum());
@@ -328,7 +362,7 @@ std::set<std::shared_ptr<Value>> ValueCollection::getRelatedValues(
         return *new_value == &value->getLLVMValue_() &&
                new_value->GetFields().size() >= value->GetFields().size() &&
                (value->GetFields().empty() ||
-                value->GetFields().back().field == Value::kNonFieldVariable ||
+                value->GetFields().back().field < 0 ||
                 value->GetFields().back().field ==
                     new_value->GetFields()[value->GetFields().size() - 1]
                         .field);
@@ -391,18 +425,6 @@ const ValueCollection* AliasValues::getAliasInfo(
   return nullptr;
 }
 
-ManagedValues ManagedValues::GetInstance() {
-  static ManagedValues* managed_values = new ManagedValues();
-  return *managed_values;
-}
-
-ManagedValues::ManagedValues() { managed_values_.reserve(kReserveSize); }
-
-std::shared_ptr<framework::Value> ManagedValues::getValueFromID(size_t id) {
-  if (id > Size()) return nullptr;
-  return managed_values_[id];
-}
-
 llvm::raw_ostream& operator<<(llvm::raw_ostream& ostream,
                               const framework::Value& value) {
   ostream << "[framework::Value] ";
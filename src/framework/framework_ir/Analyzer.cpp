@@ -1,5 +1,7 @@
 #include "framework_ir/Analyzer.hpp"
 
+#include <algorithm>
+
 #include "core/AnalysisHelper.hpp"
 #include "core/BasicBlock.hpp"
 #include "core/Casting.hpp"
@@ -8,6 +10,7 @@
 #include "core/Utils.hpp"
 #include "core/Value.hpp"
 #include "framework_ir/Utils.hpp"
+#include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/Analysis/LoopInfo.h"
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/Function.h"
@@ -24,13 +27,8 @@ void Analyzer::analyze(llvm::Function& function, llvm::LoopInfo& loop_info) {
   framework_function_ = framework::Function::createManagedFunction(
       &function, std::make_unique<llvm::LoopInfo>(std::move(loop_info)));
 
-  std::vector<std::shared_ptr<framework::BasicBlock>> block;
   for (auto& basic_block : function) {
-    auto framework_block = framework_function_->getBasicBlock(&basic_block);
-    if (framework_block->Id() == framework::BasicBlock::kNoId) {
-      framework_block->setId(block.size());
-      block.push_back(framework_block);
-    }
+    framework_function_->getBasicBlock(&basic_block);
     for (auto& instruction : basic_block) {
       switch (instruction.getOpcode()) {
         case llvm::Instruction::Call:
@@ -50,7 +48,35 @@ void Analyzer::analyze(llvm::Function& function, llvm::LoopInfo& loop_info) {
       }
     }
   }
-  framework_function_->addOrderedBlock(block);
+  framework_function_->buildCFG();
+  for (auto& framework_block : framework_function_->OrderedBasicBlocks())
+    analyzeBranchInst(framework_block);
+  numberInstructions(function);
+}
+
+// The blocks in reverse post order, then the unreachable ones in layout
+// order, each numbering its instructions and then its branch
+void Analyzer::numberInstructions(llvm::Function& function) {
+  std::vector<std::shared_ptr<framework::BasicBlock>> blocks;
+  std::vector<bool> numbered(
+      framework_function_->OrderedBasicBlocks().size(), false);
+  for (auto basic_block : llvm::ReversePostOrderTraversal<llvm::Function*>(
+           &function)) {
+    auto framework_block = framework_function_->getBasicBlock(basic_block);
+    numbered[framework_block->Id()] = true;
+    blocks.push_back(framework_block);
+  }
+  for (auto& framework_block : framework_function_->OrderedBasicBlocks()) {
+    if (!numbered[framework_block->Id()]) blocks.push_back(framework_block);
+  }
+
+  uint32_t sequence = 0;
+  for (auto& framework_block : blocks) {
+    for (auto& inst : framework_block->Instructions())
+      inst->setSequence(&function, sequence++);
+    if (auto branch_inst = framework_block->getBranchInst())
+      branch_inst->setSequence(&function, sequence++);
+  }
 }
 
 void Analyzer::analyzeCallInst(llvm::Instruction* instruction) {
@@ -144,6 +170,64 @@ void Analyzer::analyzeLoadInst(llvm::Instruction* inst) {
   framework_block->addInstruction(framework_load);
 }
 
+void Analyzer::analyzeBranchInst(
+    std::shared_ptr<framework::BasicBlock> block) {
+  auto branch_inst = block->getBranchInst();
+  if (!branch_inst) return;
+
+  framework::BranchFacts facts;
+  std::shared_ptr<framework::CompareInst> compare_inst;
+  if (auto condition = branch_inst->Condition()) {
+    if (auto call_inst =
+            framework::shared_dyn_cast<framework::CallInst>(condition))
+      facts.calls.push_back(call_inst);
+    compare_inst = framework::shared_dyn_cast<framework::CompareInst>(condition);
+  }
+
+  if (compare_inst) {
+    facts.predicate = compare_inst->GetPredicate();
+    for (auto& operand : compare_inst->Operands()) {
+      if (auto call_inst =
+              framework::shared_dyn_cast<framework::CallInst>(operand))
+        facts.calls.push_back(call_inst);
+
+      if (framework::shared_isa<framework::NullValue>(operand)) {
+        facts.null_operand = true;
+      } else if (auto const_value =
+                     framework::shared_dyn_cast<framework::ConstValue>(
+                         operand)) {
+        facts.compared_constant = const_value->getConstValue();
+      } else {
+        facts.compared_value = operand;
+      }
+    }
+  }
+  branch_inst->setFacts(facts);
+
+  auto true_nodes = branch_inst->TruePathNodes();
+  auto false_nodes = branch_inst->FalsePathNodes();
+  auto in_nodes = [](const framework::BranchInst::TransitionNodes& nodes,
+                     const std::shared_ptr<framework::BasicBlock>& successor) {
+    return std::find_if(nodes.begin(), nodes.end(), [&successor](auto node) {
+             return node.lock() == successor;
+           }) != nodes.end();
+  };
+
+  for (auto& successor : block->Successors()) {
+    framework::EdgeFacts edge;
+    edge.true_path = in_nodes(true_nodes, successor);
+    edge.false_path = in_nodes(false_nodes, successor);
+    if (compare_inst && facts.null_operand && facts.compared_value) {
+      bool null_path = facts.predicate == llvm::CmpInst::ICMP_EQ
+                           ? edge.true_path
+                           : edge.false_path;
+      edge.refinement = null_path ? framework::EdgeFacts::NULL_PATH
+                                  : framework::EdgeFacts::NON_NULL_PATH;
+    }
+    branch_inst->setEdgeFacts(successor, edge);
+  }
+}
+
 void Analyzer::analyzeReturnInst(llvm::Instruction* instruction) {
   auto return_inst = llvm::cast<llvm::ReturnInst>(instruction);
   auto return_value = return_inst->getReturnValue();
@@ -1,13 +1,58 @@
 #include "framework_ir/IRGenerator.hpp"
 
+#include <algorithm>
+
+#include "core/Function.hpp"
+#include "core/Instructions/BranchInstruction.hpp"
+#include "core/SFG/Converter.hpp"
 #include "core/Utils.hpp"
+#include "framework_ir/Snapshot.hpp"
 #include "llvm/Analysis/LoopInfo.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
 
+static llvm::cl::opt<std::string> SnapshotDir(
+    "fitx-snapshot",
+    llvm::cl::desc("Write a snapshot of each module, as the framework IR is "
+                   "generated from it, into the given directory"));
+
 namespace ir_generator {
+static bool KeepSnapshots = false;
+
+// The snapshot is taken the first time the IR generator finalizes a module,
+// i.e. before the optimizations, so that it matches the framework IR
+static void writeSnapshot(llvm::Module &M) {
+  auto &context = framework::AnalysisContext::Current();
+  if (!context.hasFrameworkIR(&M) || !context.addSnapshot(&M)) return;
+
+  std::string name = M.getModuleIdentifier();
+  std::replace(name.begin(), name.end(), '/', '_');
+
+  snapshot::SnapshotWriter writer;
+  writer.addModule(M);
+  if (!writer.addFrameworkIR(M, context))
+    llvm::errs() << "[Snapshot] the framework IR of " << name
+                 << " is left out, it is generated again when loaded\n";
+
+  if (KeepSnapshots) {
+    llvm::raw_string_ostream stream(context.Snapshot(&M));
+    writer.write(stream);
+  }
+  if (!SnapshotDir.empty()) {
+    llvm::SmallString<128> path(SnapshotDir);
+    llvm::sys::path::append(path, name + ".fitx");
+    writer.writeToFile(std::string(path.str()));
+  }
+}
+
+void IRGenerator::keepSnapshots() { KeepSnapshots = true; }
+
 IRGenerator::IRGenerator() : FunctionPass(ID) {}
 
 void IRGenerator::getAnalysisUsage(llvm::AnalysisUsage &AU) const {
@@ -20,16 +65,51 @@ bool IRGenerator::runOnFunction(llvm::Function &F) {
   auto &loop_info = getAnalysis<llvm::LoopInfoWrapperPass>().getLoopInfo();
 
   analyzer.analyze(F, loop_info);
-  framework_ir_[F.getParent()].insert(analyzer.FrameworkFunction());
+  FrameworkIR(*F.getParent()).insert(analyzer.FrameworkFunction());
   return false;
 }
 
-};  // namespace ir_generator
+// A branch checks a returned value only once every function of the module
+// has marked the values it returns
+bool IRGenerator::doFinalization(llvm::Module &M) {
+  for (auto &function : FrameworkIR(M)) {
+    for (auto &block : function->BasicBlocks()) {
+      auto branch_inst = block->getBranchInst();
+      if (!branch_inst) continue;
+
+      auto facts = branch_inst->Facts();
+      facts.error_path = branch_inst->returnValueOperandExists();
+      branch_inst->setFacts(facts);
+    }
+  }
+
+  if (!SnapshotDir.empty() || KeepSnapshots) writeSnapshot(M);
+  return false;
+}
 
-std::map<llvm::Module *, std::set<std::shared_ptr<framework::Function>>>
-    ir_generator::IRGenerator::framework_ir_ =
-        std::map<llvm::Module *,
-                 std::set<std::shared_ptr<framework::Function>>>();
+void IRGenerator::generate(llvm::Module &M,
+                           framework::AnalysisContext &context) {
+  framework::AnalysisContext::Scope scope(context);
+  llvm::legacy::FunctionPassManager function_passes(&M);
+  function_passes.add(new IRGenerator());
+
+  function_passes.doInitialization();
+  for (auto &function : M) {
+    // Lazily loaded modules have their bodies read here. They are kept, as
+    // the framework IR refers to their instructions.
+    if (function.isMaterializable()) {
+      if (auto error = function.materialize()) {
+        llvm::consumeError(std::move(error));
+        continue;
+      }
+    }
+    if (function.isDeclaration()) continue;
+    function_passes.run(function);
+  }
+  function_passes.doFinalization();
+}
+
+};  // namespace ir_generator
 
 char ir_generator::IRGenerator::ID = 1;
 
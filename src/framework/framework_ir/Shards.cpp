@@ -0,0 +1,172 @@
+#include "framework_ir/Shards.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <numeric>
+
+#include "core/Casting.hpp"
+#include "core/Instructions.hpp"
+
+namespace ir_generator {
+namespace {
+struct CallGraphNode {
+  std::shared_ptr<framework::Function> function = nullptr;
+  std::vector<size_t> callees = {};
+  bool has_caller = false;
+  uint64_t cost = 0;
+};
+
+size_t findRoot(std::vector<size_t>& parents, size_t node) {
+  while (parents[node] != node) {
+    parents[node] = parents[parents[node]];
+    node = parents[node];
+  }
+  return node;
+}
+
+std::vector<CallGraphNode> buildCallGraph(
+    const std::set<std::shared_ptr<framework::Function>>& functions) {
+  std::vector<CallGraphNode> nodes;
+  std::map<framework::Function*, size_t> node_index;
+  for (auto& function : functions) {
+    node_index[function.get()] = nodes.size();
+    nodes.push_back(CallGraphNode{function});
+  }
+
+  for (auto& node : nodes) {
+    for (auto& block : node.function->OrderedBasicBlocks()) {
+      for (auto& inst : block->Instructions()) {
+        node.cost++;
+        auto call_inst = framework::shared_dyn_cast<framework::CallInst>(inst);
+        if (!call_inst || !call_inst->CalledFunction()) continue;
+
+        auto callee = node_index.find(call_inst->CalledFunction().get());
+        if (callee == node_index.end()) continue;
+        node.callees.push_back(callee->second);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < nodes.size(); i++) {
+    for (auto callee : nodes[i].callees)
+      if (callee != i) nodes[callee].has_caller = true;
+  }
+  return nodes;
+}
+
+struct EntryFunction {
+  size_t node;
+  // Of the functions it reaches, which its shard analyzes again
+  uint64_t cost;
+};
+
+// Entry functions of the component, plus one function of every cycle that
+// is not reachable from them
+std::vector<EntryFunction> entryFunctions(
+    const std::vector<CallGraphNode>& nodes,
+    const std::vector<size_t>& component) {
+  std::vector<EntryFunction> entries;
+  std::vector<bool> reached(nodes.size(), false);
+  // The entry that last visited each node, so that every entry walks all of
+  // its callees
+  std::vector<size_t> visited_by(nodes.size(), SIZE_MAX);
+  auto reach = [&nodes, &entries, &reached, &visited_by](size_t entry) {
+    uint64_t cost = 0;
+    std::vector<size_t> stack{entry};
+    visited_by[entry] = entry;
+    while (!stack.empty()) {
+      size_t node = stack.back();
+      stack.pop_back();
+      reached[node] = true;
+      cost += nodes[node].cost;
+      for (auto callee : nodes[node].callees) {
+        if (visited_by[callee] == entry) continue;
+        visited_by[callee] = entry;
+        stack.push_back(callee);
+      }
+    }
+    entries.push_back({entry, cost});
+  };
+
+  for (auto node : component) {
+    if (nodes[node].has_caller) continue;
+    reach(node);
+  }
+
+  for (auto node : component) {
+    if (reached[node]) continue;
+    reach(node);
+  }
+  return entries;
+}
+}  // namespace
+
+std::vector<Shard> partitionCallGraph(
+    const std::set<std::shared_ptr<framework::Function>>& functions,
+    size_t shard_count) {
+  std::vector<CallGraphNode> nodes = buildCallGraph(functions);
+  shard_count = std::max<size_t>(1, std::min(shard_count, nodes.size()));
+
+  std::vector<size_t> parents(nodes.size());
+  std::iota(parents.begin(), parents.end(), 0);
+  for (size_t i = 0; i < nodes.size(); i++) {
+    for (auto callee : nodes[i].callees)
+      parents[findRoot(parents, i)] = findRoot(parents, callee);
+  }
+
+  std::map<size_t, std::vector<size_t>> components;
+  uint64_t total_cost = 0;
+  for (size_t i = 0; i < nodes.size(); i++) {
+    components[findRoot(parents, i)].push_back(i);
+    total_cost += nodes[i].cost;
+  }
+
+  // Units are whole components, or the entry functions of the components
+  // that would not fit in a single shard
+  std::vector<Shard> units;
+  uint64_t shard_cost = total_cost / shard_count + 1;
+  for (auto& component : components) {
+    uint64_t component_cost = 0;
+    for (auto node : component.second) component_cost += nodes[node].cost;
+
+    if (component_cost <= shard_cost) {
+      Shard unit;
+      for (auto node : component.second)
+        unit.functions.push_back(nodes[node].function);
+      unit.cost = component_cost;
+      units.push_back(unit);
+      continue;
+    }
+
+    for (auto& entry : entryFunctions(nodes, component.second)) {
+      Shard unit;
+      unit.functions.push_back(nodes[entry.node].function);
+      unit.cost = entry.cost;
+      units.push_back(unit);
+    }
+  }
+
+  // Longest processing time first: the next unit goes to the cheapest shard
+  std::stable_sort(
+      units.begin(), units.end(),
+      [](const Shard& a, const Shard& b) { return a.cost > b.cost; });
+
+  std::vector<Shard> shards(shard_count);
+  for (auto& unit : units) {
+    auto shard = std::min_element(
+        shards.begin(), shards.end(),
+        [](const Shard& a, const Shard& b) { return a.cost < b.cost; });
+    shard->functions.insert(shard->functions.end(), unit.functions.begin(),
+                            unit.functions.end());
+    shard->cost += unit.cost;
+  }
+
+  shards.erase(std::remove_if(shards.begin(), shards.end(),
+                              [](const Shard& shard) {
+                                return shard.functions.empty();
+                              }),
+               shards.end());
+  return shards;
+}
+}  // namespace ir_generator
@@ -0,0 +1,1014 @@
+#include "framework_ir/Snapshot.hpp"
+
+#include <cstring>
+#include <map>
+#include <set>
+
+#include "core/BasicBlock.hpp"
+#include "core/Casting.hpp"
+#include "core/Function.hpp"
+#include "core/Instructions.hpp"
+#include "core/SFG/Converter.hpp"
+#include "core/Value.hpp"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Operator.h"
+#include "llvm/Support/FileSystem.h"
+
+namespace ir_generator {
+namespace snapshot {
+static constexpr uint64_t kAlignment = 8;
+
+ModuleIndex::ModuleIndex(llvm::Module& M) {
+  for (auto& global : M.globals()) addValue(&global);
+  for (auto& function : M) addValue(&function);
+  for (auto& alias : M.aliases()) addValue(&alias);
+  for (auto& ifunc : M.ifuncs()) addValue(&ifunc);
+  for (auto& function : M) {
+    for (auto& argument : function.args()) addValue(&argument);
+    for (auto& block : function) {
+      addValue(&block);
+      for (auto& instruction : block) addValue(&instruction);
+    }
+  }
+
+  for (auto& global : M.globals()) addOperands(&global);
+  for (auto& function : M) addOperands(&function);
+  for (auto& alias : M.aliases()) addOperands(&alias);
+  for (auto& ifunc : M.ifuncs()) addOperands(&ifunc);
+  for (auto& function : M) {
+    for (auto& instruction : llvm::instructions(function))
+      addOperands(&instruction);
+  }
+
+  // The types of the fields are the ones of the values, the allocated and
+  // indexed ones, and the types they are built from
+  for (auto value : values_) {
+    addType(value->getType());
+    if (auto global = llvm::dyn_cast<llvm::GlobalValue>(value))
+      addType(global->getValueType());
+    if (auto alloca_inst = llvm::dyn_cast<llvm::AllocaInst>(value))
+      addType(alloca_inst->getAllocatedType());
+    if (auto gep = llvm::dyn_cast<llvm::GEPOperator>(value))
+      addType(gep->getSourceElementType());
+  }
+}
+
+uint32_t ModuleIndex::valueIndex(const llvm::Value* value) const {
+  auto found = value_indices_.find(value);
+  return found != value_indices_.end() ? found->second : kNone;
+}
+
+uint32_t ModuleIndex::typeIndex(llvm::Type* type) const {
+  auto found = type_indices_.find(type);
+  return found != type_indices_.end() ? found->second : kNone;
+}
+
+void ModuleIndex::addValue(llvm::Value* value) {
+  if (value_indices_.insert({value, values_.size()}).second)
+    values_.push_back(value);
+}
+
+void ModuleIndex::addOperands(llvm::User* user) {
+  for (auto& operand : user->operands()) {
+    llvm::Value* value = operand.get();
+    if (!value || value_indices_.count(value)) continue;
+    addValue(value);
+    if (auto constant = llvm::dyn_cast<llvm::Constant>(value))
+      addOperands(constant);
+  }
+}
+
+void ModuleIndex::addType(llvm::Type* type) {
+  if (!type || !type_indices_.insert({type, types_.size()}).second) return;
+  types_.push_back(type);
+
+  for (auto subtype : type->subtypes()) addType(subtype);
+  if (type->isPointerTy() && !type->isOpaquePointerTy())
+    addType(type->getPointerElementType());
+}
+
+// Gives the framework values reachable from the functions of a module their
+// index, and records them along with the functions and their blocks
+class SnapshotWriter::Recorder {
+ public:
+  Recorder(SnapshotWriter& writer, const ModuleIndex& index)
+      : writer_(writer), index_(index) {}
+
+  bool record(llvm::Module& M, framework::AnalysisContext& context);
+
+ private:
+  ValueKind kindOf(framework::Value* value);
+  uint32_t valueIndex(std::shared_ptr<framework::Value> value);
+  uint32_t llvmIndex(const llvm::Value* value);
+  uint32_t blockIndex(std::shared_ptr<framework::BasicBlock> block);
+
+  template <class Values>
+  Range addRefs(const Values& values);
+
+  FunctionRecord recordFunction(framework::Function& function,
+                                bool framework_ir);
+  BlockRecord recordBlock(framework::Function& function,
+                          std::shared_ptr<framework::BasicBlock> block);
+  ValueRecord recordValue(std::shared_ptr<framework::Value> value);
+  BranchRecord recordBranch(framework::BranchInst& branch_inst);
+
+  SnapshotWriter& writer_;
+  const ModuleIndex& index_;
+  bool failed_ = false;
+
+  std::vector<std::shared_ptr<framework::Value>> values_;
+  std::map<framework::Value*, uint32_t> value_indices_;
+  std::map<framework::Value*, ValueKind> kinds_;
+  std::set<framework::Value*> managed_;
+};
+
+bool SnapshotWriter::Recorder::record(llvm::Module& M,
+                                      framework::AnalysisContext& context) {
+  std::vector<std::shared_ptr<framework::Function>> functions;
+  for (auto& created : context.CreatedFunctions()) {
+    if (created.first->getParent() == &M) functions.push_back(created.second);
+  }
+
+  // The classes the IR generator gave to the values of the blocks
+  for (auto& function : functions) {
+    for (auto& block : function->BasicBlocks()) {
+      if (!block) continue;
+      for (auto& inst : block->Instructions()) {
+        switch (inst->Opcode()) {
+          case llvm::Instruction::Call:
+            kinds_[inst.get()] = CALL;
+            break;
+          case llvm::Instruction::Store:
+            kinds_[inst.get()] = STORE;
+            break;
+          case llvm::Instruction::Load:
+            kinds_[inst.get()] = LOAD;
+            break;
+          default:
+            break;
+        }
+      }
+
+      auto branch_inst = block->getBranchInst();
+      if (!branch_inst) continue;
+      kinds_[branch_inst.get()] = BRANCH;
+      if (auto condition = branch_inst->Condition())
+        kinds_[condition.get()] =
+            condition->Opcode() == llvm::Instruction::ICmp ? COMPARE : CALL;
+    }
+  }
+
+  // The managed values first, in the order the converter looks them up
+  for (auto& managed : context.getConverter().ManagedValues()) {
+    if (index_.valueIndex(managed.first) == kNone) continue;
+    for (auto& value : managed.second) {
+      valueIndex(value);
+      managed_.insert(value.get());
+    }
+  }
+
+  bool has_framework_ir = context.hasFrameworkIR(&M);
+  for (auto& function : functions) {
+    bool framework_ir =
+        has_framework_ir && context.FrameworkIR(&M).count(function);
+    writer_.functions_.push_back(recordFunction(*function, framework_ir));
+  }
+
+  // Recording a value may index the values it refers to
+  for (size_t i = 0; i < values_.size() && !failed_; i++)
+    writer_.values_.push_back(recordValue(values_[i]));
+  return !failed_;
+}
+
+ValueKind SnapshotWriter::Recorder::kindOf(framework::Value* value) {
+  auto kind = kinds_.find(value);
+  if (kind != kinds_.end()) return kind->second;
+
+  switch (value->getValueID()) {
+    case llvm::Value::ConstantIntVal:
+      return CONST_VALUE;
+    case llvm::Value::ConstantPointerNullVal:
+      return NULL_VALUE;
+    case llvm::Value::ArgumentVal:
+      return ARGUMENT;
+    default:
+      break;
+  }
+
+  if (auto inst = llvm::dyn_cast<framework::Instruction>(value))
+    return inst->Opcode() == llvm::Instruction::Call ? CALL : INSTRUCTION;
+  return VALUE;
+}
+
+uint32_t SnapshotWriter::Recorder::valueIndex(
+    std::shared_ptr<framework::Value> value) {
+  if (!value) return kNone;
+
+  auto found = value_indices_.find(value.get());
+  if (found != value_indices_.end()) return found->second;
+
+  uint32_t index = values_.size();
+  value_indices_[value.get()] = index;
+  values_.push_back(value);
+  return index;
+}
+
+uint32_t SnapshotWriter::Recorder::llvmIndex(const llvm::Value* value) {
+  if (!value) return kNone;
+  uint32_t index = index_.valueIndex(value);
+  if (index == kNone) failed_ = true;
+  return index;
+}
+
+uint32_t SnapshotWriter::Recorder::blockIndex(
+    std::shared_ptr<framework::BasicBlock> block) {
+  return block ? llvmIndex(block->LLVMBasicBlock()) : kNone;
+}
+
+template <class Values>
+Range SnapshotWriter::Recorder::addRefs(const Values& values) {
+  std::vector<uint32_t> indices;
+  for (auto& value : values) indices.push_back(valueIndex(value));
+
+  Range range{static_cast<uint32_t>(writer_.refs_.size()),
+              static_cast<uint32_t>(indices.size())};
+  writer_.refs_.insert(writer_.refs_.end(), indices.begin(), indices.end());
+  return range;
+}
+
+FunctionRecord SnapshotWriter::Recorder::recordFunction(
+    framework::Function& function, bool framework_ir) {
+  FunctionRecord record{};
+  record.function = llvmIndex(function.LLVMFunction());
+  record.flags = 0;
+  if (framework_ir) record.flags |= FRAMEWORK_IR;
+  if (function.ContainsLoopBackBlock()) record.flags |= LOOP_BACK;
+  if (function.hasLoopInfo()) record.flags |= LOOP_INFO;
+  record.return_value = valueIndex(function.getReturnValue());
+  record.return_block = blockIndex(function.ReturnBlock());
+  record.protected_refcount_value =
+      valueIndex(function.ProtectedRefcountValue());
+  record.last_refcount_call = valueIndex(function.lastRefcountInstruction());
+
+  auto& blocks = function.BasicBlocks();
+  std::vector<BlockRecord> block_records;
+  for (auto& block : blocks)
+    block_records.push_back(recordBlock(function, block));
+  record.blocks = {static_cast<uint32_t>(writer_.blocks_.size()),
+                   static_cast<uint32_t>(block_records.size())};
+  writer_.blocks_.insert(writer_.blocks_.end(), block_records.begin(),
+                         block_records.end());
+
+  auto& pairs = writer_.pairs_;
+  record.successors.begin = pairs.size();
+  for (auto& block : blocks) {
+    if (!block) continue;
+    for (auto& successor : block->Successors())
+      pairs.push_back({static_cast<uint32_t>(block->Id()),
+                       static_cast<uint32_t>(successor->Id())});
+  }
+  record.successors.size = pairs.size() - record.successors.begin;
+
+  record.predecessors.begin = pairs.size();
+  for (auto& block : blocks) {
+    if (!block) continue;
+    for (auto& predecessor : block->Predecessors())
+      pairs.push_back({static_cast<uint32_t>(block->Id()),
+                       static_cast<uint32_t>(predecessor->Id())});
+  }
+  record.predecessors.size = pairs.size() - record.predecessors.begin;
+
+  std::vector<PairRecord> assignments;
+  for (auto& assignment : function.getReturnAssignments())
+    assignments.push_back(
+        {blockIndex(assignment.first), valueIndex(assignment.second)});
+  record.return_assignments = {static_cast<uint32_t>(pairs.size()),
+                               static_cast<uint32_t>(assignments.size())};
+  pairs.insert(pairs.end(), assignments.begin(), assignments.end());
+
+  std::vector<uint32_t> callers;
+  for (auto& caller : function.CallerFunctions())
+    callers.push_back(llvmIndex(caller->LLVMFunction()));
+  record.callers = {static_cast<uint32_t>(writer_.refs_.size()),
+                    static_cast<uint32_t>(callers.size())};
+  writer_.refs_.insert(writer_.refs_.end(), callers.begin(), callers.end());
+  return record;
+}
+
+BlockRecord SnapshotWriter::Recorder::recordBlock(
+    framework::Function& function,
+    std::shared_ptr<framework::BasicBlock> block) {
+  BlockRecord record{kNone, 0, kNone, 0, {}, {}, {}};
+  if (!block) return record;
+
+  record.block = blockIndex(block);
+  if (function.hasLoopInfo() && function.isLoopBlock(block))
+    record.flags |= LOOP_BLOCK;
+  record.branch = valueIndex(block->getBranchInst());
+  record.instructions = addRefs(block->Instructions());
+  record.dead_values = addRefs(block->DeadValues());
+
+  std::vector<PairRecord> pass_through;
+  for (auto& passthrough : block->PassthroughBlocks()) {
+    auto successor = passthrough.first.lock();
+    if (!successor) continue;
+    for (auto& predecessor : passthrough.second) {
+      if (auto pred_block = predecessor.lock())
+        pass_through.push_back({blockIndex(successor), blockIndex(pred_block)});
+    }
+  }
+  record.pass_through = {static_cast<uint32_t>(writer_.pairs_.size()),
+                         static_cast<uint32_t>(pass_through.size())};
+  writer_.pairs_.insert(writer_.pairs_.end(), pass_through.begin(),
+                        pass_through.end());
+  return record;
+}
+
+ValueRecord SnapshotWriter::Recorder::recordValue(
+    std::shared_ptr<framework::Value> value) {
+  ValueRecord record{};
+  record.kind = kindOf(value.get());
+  record.value = llvmIndex(value->LLVMValue());
+  if (record.value == kNone) failed_ = true;
+  record.value_id = value->getValueID();
+  record.flags = 0;
+  if (value->isReturnValue()) record.flags |= RETURN_VALUE;
+  if (managed_.count(value.get())) record.flags |= MANAGED;
+  record.array_element_num = value->ArrayElementNum();
+
+  auto& fields = writer_.fields_;
+  record.fields.begin = fields.size();
+  for (auto& field : value->GetFields()) {
+    uint32_t type = field.type ? index_.typeIndex(field.type) : kNone;
+    if (field.type && type == kNone) failed_ = true;
+    fields.push_back({type, 0, field.field});
+  }
+  record.fields.size = fields.size() - record.fields.begin;
+
+  record.sequence = framework::Instruction::kNoSequence;
+  record.sequence_function = kNone;
+  if (auto inst = framework::shared_dyn_cast<framework::Instruction>(value)) {
+    record.sequence = inst->Sequence();
+    record.sequence_function = llvmIndex(inst->SequenceFunction());
+  }
+
+  switch (record.kind) {
+    case CALL:
+      record.operands = addRefs(
+          std::static_pointer_cast<framework::CallInst>(value)->Arguments());
+      break;
+    case STORE: {
+      auto store_inst = std::static_pointer_cast<framework::StoreInst>(value);
+      record.operands = addRefs(std::vector<std::shared_ptr<framework::Value>>{
+          store_inst->ValueOperand(), store_inst->PointerOperand()});
+      break;
+    }
+    case LOAD:
+      record.operands = addRefs(std::vector<std::shared_ptr<framework::Value>>{
+          std::static_pointer_cast<framework::LoadInst>(value)->LoadValue()});
+      break;
+    case COMPARE: {
+      auto compare_inst =
+          std::static_pointer_cast<framework::CompareInst>(value);
+      record.operands = addRefs(compare_inst->Operands());
+      record.extra = addRefs(compare_inst->Replaced());
+      break;
+    }
+    case BRANCH: {
+      auto branch = recordBranch(
+          *std::static_pointer_cast<framework::BranchInst>(value));
+      record.extra = {static_cast<uint32_t>(writer_.branches_.size()), 1};
+      writer_.branches_.push_back(branch);
+      break;
+    }
+    default:
+      break;
+  }
+  return record;
+}
+
+BranchRecord SnapshotWriter::Recorder::recordBranch(
+    framework::BranchInst& branch_inst) {
+  auto& facts = branch_inst.Facts();
+  BranchRecord record{};
+  record.condition = valueIndex(branch_inst.Condition());
+  record.predicate = facts.predicate;
+  record.compared_value = valueIndex(facts.compared_value);
+  record.flags = 0;
+  if (facts.null_operand) record.flags |= NULL_OPERAND;
+  if (facts.error_path) record.flags |= ERROR_PATH;
+  record.compared_constant = facts.compared_constant;
+  record.calls = addRefs(facts.calls);
+
+  auto& nodes = writer_.nodes_;
+  record.nodes.begin = nodes.size();
+  for (auto& transition : branch_inst.Nodes()) {
+    for (auto& node : transition.second) {
+      if (auto block = node.lock())
+        nodes.push_back({transition.first, blockIndex(block), 0});
+    }
+  }
+  record.nodes.size = nodes.size() - record.nodes.begin;
+
+  auto& pairs = writer_.pairs_;
+  record.edges.begin = pairs.size();
+  if (auto block = branch_inst.Parent().lock()) {
+    for (auto& successor : block->Successors()) {
+      auto edge = branch_inst.getEdgeFacts(successor);
+      if (!edge) continue;
+      uint32_t packed = (edge->true_path ? 1 : 0) |
+                        (edge->false_path ? 2 : 0) | (edge->refinement << 2);
+      pairs.push_back({blockIndex(successor), packed});
+    }
+  }
+  record.edges.size = pairs.size() - record.edges.begin;
+  return record;
+}
+
+void SnapshotWriter::addModule(llvm::Module& M) {
+  bitcode_.clear();
+  llvm::raw_svector_ostream bitcode_stream(bitcode_);
+  llvm::WriteBitcodeToFile(M, bitcode_stream);
+}
+
+bool SnapshotWriter::addFrameworkIR(llvm::Module& M,
+                                    framework::AnalysisContext& context) {
+  clearRecords();
+  ModuleIndex index(M);
+  Recorder recorder(*this, index);
+  if (!recorder.record(M, context)) {
+    clearRecords();
+    return false;
+  }
+
+  value_count_ = index.valueCount();
+  type_count_ = index.typeCount();
+  return true;
+}
+
+void SnapshotWriter::clearRecords() {
+  value_count_ = type_count_ = 0;
+  values_.clear();
+  fields_.clear();
+  refs_.clear();
+  pairs_.clear();
+  nodes_.clear();
+  branches_.clear();
+  blocks_.clear();
+  functions_.clear();
+}
+
+void SnapshotWriter::write(llvm::raw_ostream& stream) {
+  Header header{};
+  header.magic = kMagic;
+  header.version = kVersion;
+  header.value_count = value_count_;
+  header.type_count = type_count_;
+
+  uint64_t offset = llvm::alignTo(sizeof(Header), kAlignment);
+  auto place = [&offset](Section& section, uint64_t size) {
+    section.offset = offset;
+    section.size = size;
+    offset = llvm::alignTo(offset + size, kAlignment);
+  };
+  place(header.bitcode, bitcode_.size());
+  place(header.values, values_.size() * sizeof(ValueRecord));
+  place(header.fields, fields_.size() * sizeof(FieldRecord));
+  place(header.refs, refs_.size() * sizeof(uint32_t));
+  place(header.pairs, pairs_.size() * sizeof(PairRecord));
+  place(header.nodes, nodes_.size() * sizeof(NodeRecord));
+  place(header.branches, branches_.size() * sizeof(BranchRecord));
+  place(header.blocks, blocks_.size() * sizeof(BlockRecord));
+  place(header.functions, functions_.size() * sizeof(FunctionRecord));
+
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  uint64_t written = sizeof(header);
+  auto emit = [&stream, &written](const Section& section, const void* data) {
+    stream.write_zeros(section.offset - written);
+    stream.write(static_cast<const char*>(data), section.size);
+    written = section.offset + section.size;
+  };
+  emit(header.bitcode, bitcode_.data());
+  emit(header.values, values_.data());
+  emit(header.fields, fields_.data());
+  emit(header.refs, refs_.data());
+  emit(header.pairs, pairs_.data());
+  emit(header.nodes, nodes_.data());
+  emit(header.branches, branches_.data());
+  emit(header.blocks, blocks_.data());
+  emit(header.functions, functions_.data());
+}
+
+bool SnapshotWriter::writeToFile(const std::string& path) {
+  std::error_code error;
+  llvm::raw_fd_ostream stream(path, error, llvm::sys::fs::OF_None);
+  if (error) {
+    llvm::errs() << "[Snapshot] cannot open " << path << ": "
+                 << error.message() << "\n";
+    return false;
+  }
+
+  write(stream);
+  stream.close();
+  if (stream.has_error()) {
+    llvm::errs() << "[Snapshot] cannot write " << path << ": "
+                 << stream.error().message() << "\n";
+    stream.clear_error();
+    llvm::sys::fs::remove(path);
+    return false;
+  }
+  return true;
+}
+
+std::unique_ptr<SnapshotReader> SnapshotReader::open(const std::string& path) {
+  auto buffer = llvm::MemoryBuffer::getFile(path, /* IsText */ false,
+                                            /* RequiresNullTerminator */ false);
+  if (!buffer) {
+    llvm::errs() << "[Snapshot] cannot open " << path << ": "
+                 << buffer.getError().message() << "\n";
+    return nullptr;
+  }
+
+  return open(std::move(*buffer));
+}
+
+std::unique_ptr<SnapshotReader> SnapshotReader::open(
+    std::unique_ptr<llvm::MemoryBuffer> buffer) {
+  std::string name = buffer->getBufferIdentifier().str();
+  std::unique_ptr<SnapshotReader> reader(new SnapshotReader());
+  if (!reader->map(std::move(buffer))) {
+    llvm::errs() << "[Snapshot] " << name << " is not a valid snapshot\n";
+    return nullptr;
+  }
+  return reader;
+}
+
+template <class Record>
+bool SnapshotReader::mapSection(const Section& section,
+                                llvm::ArrayRef<Record>& records) {
+  uint64_t buffer_size = buffer_->getBufferSize();
+  if (section.offset > buffer_size ||
+      section.size > buffer_size - section.offset ||
+      section.offset % alignof(Record) || section.size % sizeof(Record))
+    return false;
+
+  records = llvm::ArrayRef<Record>(
+      reinterpret_cast<const Record*>(buffer_->getBufferStart() +
+                                      section.offset),
+      section.size / sizeof(Record));
+  return true;
+}
+
+bool SnapshotReader::map(std::unique_ptr<llvm::MemoryBuffer> buffer) {
+  buffer_ = std::move(buffer);
+  // The records are read in place
+  if (reinterpret_cast<uintptr_t>(buffer_->getBufferStart()) % kAlignment)
+    buffer_ = llvm::MemoryBuffer::getMemBufferCopy(
+        buffer_->getBuffer(), buffer_->getBufferIdentifier());
+
+  if (buffer_->getBufferSize() < sizeof(Header)) return false;
+  memcpy(&header_, buffer_->getBufferStart(), sizeof(header_));
+  if (header_.magic != kMagic || header_.version != kVersion) return false;
+
+  llvm::ArrayRef<char> bitcode;
+  if (!mapSection(header_.bitcode, bitcode) ||
+      !mapSection(header_.values, values_) ||
+      !mapSection(header_.fields, fields_) ||
+      !mapSection(header_.refs, refs_) ||
+      !mapSection(header_.pairs, pairs_) ||
+      !mapSection(header_.nodes, nodes_) ||
+      !mapSection(header_.branches, branches_) ||
+      !mapSection(header_.blocks, blocks_) ||
+      !mapSection(header_.functions, functions_))
+    return false;
+  bitcode_ = llvm::StringRef(bitcode.data(), bitcode.size());
+  return true;
+}
+
+std::unique_ptr<llvm::Module> SnapshotReader::loadModule(
+    llvm::LLVMContext& context) const {
+  if (!hasBitcode()) return nullptr;
+
+  auto module = llvm::parseBitcodeFile(
+      llvm::MemoryBufferRef(bitcode_, buffer_->getBufferIdentifier()),
+      context);
+  if (!module) {
+    llvm::errs() << "[Snapshot] " << llvm::toString(module.takeError())
+                 << "\n";
+    return nullptr;
+  }
+  return std::move(*module);
+}
+
+// Rebuilds the functions and their blocks first, so that the instructions
+// find their parent block, then the values, then links them together
+class SnapshotReader::Loader {
+ public:
+  Loader(const SnapshotReader& reader, llvm::Module& M)
+      : reader_(reader), module_(M), index_(M) {}
+
+  bool load(framework::AnalysisContext& context);
+
+ private:
+  template <class Record>
+  llvm::ArrayRef<Record> records(llvm::ArrayRef<Record> section, Range range);
+
+  std::shared_ptr<framework::Value> value(uint32_t index);
+  std::vector<std::shared_ptr<framework::Value>> values(Range range);
+  std::shared_ptr<framework::BasicBlock> block(uint32_t index);
+
+  void addBlocks(const FunctionRecord& record,
+                 std::shared_ptr<framework::Function> function);
+  std::shared_ptr<framework::Value> createValue(const ValueRecord& record);
+  void linkValue(const ValueRecord& record,
+                 std::shared_ptr<framework::Value> value);
+  void linkBranch(const BranchRecord& record,
+                  framework::BranchInst& branch_inst);
+  void linkFunction(const FunctionRecord& record,
+                    std::shared_ptr<framework::Function> function);
+
+  const SnapshotReader& reader_;
+  llvm::Module& module_;
+  ModuleIndex index_;
+  bool failed_ = false;
+
+  std::vector<std::shared_ptr<framework::Function>> functions_;
+  std::vector<std::shared_ptr<framework::Value>> values_;
+};
+
+template <class Record>
+llvm::ArrayRef<Record> SnapshotReader::Loader::records(
+    llvm::ArrayRef<Record> section, Range range) {
+  if (static_cast<uint64_t>(range.begin) + range.size > section.size()) {
+    failed_ = true;
+    return {};
+  }
+  return section.slice(range.begin, range.size);
+}
+
+std::shared_ptr<framework::Value> SnapshotReader::Loader::value(
+    uint32_t index) {
+  if (index == kNone) return nullptr;
+  if (index >= values_.size()) {
+    failed_ = true;
+    return nullptr;
+  }
+  return values_[index];
+}
+
+std::vector<std::shared_ptr<framework::Value>> SnapshotReader::Loader::values(
+    Range range) {
+  std::vector<std::shared_ptr<framework::Value>> loaded;
+  for (auto index : records(reader_.refs_, range))
+    loaded.push_back(value(index));
+  return loaded;
+}
+
+std::shared_ptr<framework::BasicBlock> SnapshotReader::Loader::block(
+    uint32_t index) {
+  if (index == kNone) return nullptr;
+  auto basic_block =
+      llvm::dyn_cast_or_null<llvm::BasicBlock>(index_.value(index));
+  if (!basic_block) {
+    failed_ = true;
+    return nullptr;
+  }
+  return framework::Function::createManagedFunction(basic_block->getParent())
+      ->addBasicBlock(basic_block);
+}
+
+bool SnapshotReader::Loader::load(framework::AnalysisContext& context) {
+  if (index_.valueCount() != reader_.header_.value_count ||
+      index_.typeCount() != reader_.header_.type_count)
+    return false;
+
+  for (auto& record : reader_.functions_) {
+    auto llvm_function =
+        llvm::dyn_cast_or_null<llvm::Function>(index_.value(record.function));
+    if (!llvm_function) return false;
+    auto function = framework::Function::createManagedFunction(llvm_function);
+    addBlocks(record, function);
+    functions_.push_back(function);
+  }
+  if (failed_) return false;
+
+  auto& converter = context.getConverter();
+  for (auto& record : reader_.values_) {
+    auto value = createValue(record);
+    if (!value) return false;
+    if (record.flags & MANAGED)
+      converter.manageValue(&value->getLLVMValue_(), value);
+    values_.push_back(value);
+  }
+
+  for (size_t i = 0; i < values_.size() && !failed_; i++)
+    linkValue(reader_.values_[i], values_[i]);
+  for (size_t i = 0; i < functions_.size() && !failed_; i++)
+    linkFunction(reader_.functions_[i], functions_[i]);
+  if (failed_) return false;
+
+  for (size_t i = 0; i < functions_.size(); i++) {
+    if (reader_.functions_[i].flags & FRAMEWORK_IR)
+      context.FrameworkIR(&module_).insert(functions_[i]);
+  }
+  return true;
+}
+
+void SnapshotReader::Loader::addBlocks(
+    const FunctionRecord& record,
+    std::shared_ptr<framework::Function> function) {
+  uint32_t id = 0;
+  for (auto& block_record : records(reader_.blocks_, record.blocks)) {
+    uint32_t block_id = id++;
+    if (block_record.block == kNone) continue;
+
+    auto basic_block = llvm::dyn_cast_or_null<llvm::BasicBlock>(
+        index_.value(block_record.block));
+    if (!basic_block || basic_block->getParent() != function->LLVMFunction() ||
+        function->addBasicBlock(basic_block)->Id() != block_id) {
+      failed_ = true;
+      return;
+    }
+  }
+}
+
+std::shared_ptr<framework::Value> SnapshotReader::Loader::createValue(
+    const ValueRecord& record) {
+  llvm::Value* llvm_value = index_.value(record.value);
+  if (!llvm_value || llvm_value->getValueID() != record.value_id)
+    return nullptr;
+
+  std::vector<framework::Value::Fields> fields;
+  for (auto& field : records(reader_.fields_, record.fields)) {
+    llvm::Type* type = nullptr;
+    if (field.type != kNone && !(type = index_.type(field.type)))
+      return nullptr;
+    fields.push_back(framework::Value::Fields(type, field.field));
+  }
+  if (failed_) return nullptr;
+  long array_element_num = record.array_element_num;
+
+  std::shared_ptr<framework::Value> value;
+  switch (record.kind) {
+    case VALUE:
+      value = std::make_shared<framework::Value>(llvm_value, fields,
+                                                 array_element_num);
+      break;
+    case CONST_VALUE:
+      if (auto constant = llvm::dyn_cast<llvm::ConstantInt>(llvm_value))
+        value = std::make_shared<framework::ConstValue>(constant);
+      break;
+    case NULL_VALUE:
+      if (auto null = llvm::dyn_cast<llvm::ConstantPointerNull>(llvm_value))
+        value = std::make_shared<framework::NullValue>(null);
+      break;
+    case ARGUMENT:
+      if (auto argument = llvm::dyn_cast<llvm::Argument>(llvm_value))
+        value = std::make_shared<framework::Argument>(argument, fields,
+                                                      array_element_num);
+      break;
+    case INSTRUCTION:
+      if (auto inst = llvm::dyn_cast<llvm::Instruction>(llvm_value))
+        value = std::make_shared<framework::Instruction>(inst, fields,
+                                                         array_element_num);
+      break;
+    case CALL:
+      if (auto call_inst = llvm::dyn_cast<llvm::CallInst>(llvm_value))
+        value = std::make_shared<framework::CallInst>(call_inst, fields,
+                                                      array_element_num);
+      break;
+    case STORE:
+      if (auto store_inst = llvm::dyn_cast<llvm::StoreInst>(llvm_value))
+        value = std::make_shared<framework::StoreInst>(store_inst, fields,
+                                                       array_element_num);
+      break;
+    case LOAD:
+      if (auto load_inst = llvm::dyn_cast<llvm::LoadInst>(llvm_value))
+        value = std::make_shared<framework::LoadInst>(load_inst, fields,
+                                                      array_element_num);
+      break;
+    case COMPARE:
+      if (auto icmp_inst = llvm::dyn_cast<llvm::ICmpInst>(llvm_value))
+        value = std::make_shared<framework::CompareInst>(icmp_inst, fields,
+                                                         array_element_num);
+      break;
+    case BRANCH:
+      if (auto branch_inst = llvm::dyn_cast<llvm::BranchInst>(llvm_value))
+        value = std::make_shared<framework::BranchInst>(branch_inst, fields,
+                                                        array_element_num);
+      else if (auto switch_inst = llvm::dyn_cast<llvm::SwitchInst>(llvm_value))
+        value = std::make_shared<framework::BranchInst>(switch_inst, fields,
+                                                        array_element_num);
+      break;
+    default:
+      break;
+  }
+  if (!value) return nullptr;
+
+  if (record.flags & RETURN_VALUE) value->setReturnValue(true);
+  if (record.sequence != framework::Instruction::kNoSequence) {
+    auto inst = framework::shared_dyn_cast<framework::Instruction>(value);
+    auto function = llvm::dyn_cast_or_null<llvm::Function>(
+        index_.value(record.sequence_function));
+    if (!inst || !function) return nullptr;
+    inst->setSequence(function, record.sequence);
+  }
+  return value;
+}
+
+void SnapshotReader::Loader::linkValue(
+    const ValueRecord& record, std::shared_ptr<framework::Value> value) {
+  auto operands = values(record.operands);
+  switch (record.kind) {
+    case CALL:
+      std::static_pointer_cast<framework::CallInst>(value)->setArguments(
+          operands);
+      break;
+    case STORE: {
+      if (operands.size() != 2) {
+        failed_ = true;
+        break;
+      }
+      auto store_inst = std::static_pointer_cast<framework::StoreInst>(value);
+      store_inst->setValue(operands[0]);
+      store_inst->setPointer(operands[1]);
+      break;
+    }
+    case LOAD:
+      if (operands.size() != 1) {
+        failed_ = true;
+        break;
+      }
+      std::static_pointer_cast<framework::LoadInst>(value)->setValue(
+          operands[0]);
+      break;
+    case COMPARE: {
+      auto compare_inst =
+          std::static_pointer_cast<framework::CompareInst>(value);
+      compare_inst->setOperands(operands);
+      compare_inst->setReplaced(values(record.extra));
+      break;
+    }
+    case BRANCH: {
+      auto branch = records(reader_.branches_, record.extra);
+      if (branch.size() != 1) {
+        failed_ = true;
+        break;
+      }
+      linkBranch(branch.front(),
+                 *std::static_pointer_cast<framework::BranchInst>(value));
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+void SnapshotReader::Loader::linkBranch(const BranchRecord& record,
+                                        framework::BranchInst& branch_inst) {
+  if (auto condition = value(record.condition)) {
+    auto inst = framework::shared_dyn_cast<framework::Instruction>(condition);
+    if (!inst) {
+      failed_ = true;
+      return;
+    }
+    branch_inst.setCondition(inst);
+  }
+
+  for (auto& node : records(reader_.nodes_, record.nodes)) {
+    if (auto node_block = block(node.block))
+      branch_inst.setTransitionNode(node.code, node_block);
+  }
+
+  framework::BranchFacts facts;
+  for (auto& call : values(record.calls)) {
+    if (!call || !framework::shared_isa<framework::CallInst>(call)) {
+      failed_ = true;
+      return;
+    }
+    facts.calls.push_back(std::static_pointer_cast<framework::CallInst>(call));
+  }
+  facts.predicate = static_cast<llvm::CmpInst::Predicate>(record.predicate);
+  facts.null_operand = record.flags & NULL_OPERAND;
+  facts.compared_constant = record.compared_constant;
+  facts.compared_value = value(record.compared_value);
+  facts.error_path = record.flags & ERROR_PATH;
+  branch_inst.setFacts(facts);
+
+  for (auto& edge : records(reader_.pairs_, record.edges)) {
+    framework::EdgeFacts edge_facts;
+    edge_facts.true_path = edge.second & 1;
+    edge_facts.false_path = edge.second & 2;
+    edge_facts.refinement =
+        static_cast<framework::EdgeFacts::Refinement>(edge.second >> 2);
+    if (auto successor = block(edge.first))
+      branch_inst.setEdgeFacts(successor, edge_facts);
+  }
+}
+
+void SnapshotReader::Loader::linkFunction(
+    const FunctionRecord& record,
+    std::shared_ptr<framework::Function> function) {
+  auto& blocks = function->BasicBlocks();
+  auto block_records = records(reader_.blocks_, record.blocks);
+  if (failed_ || block_records.size() > blocks.size()) {
+    failed_ = true;
+    return;
+  }
+
+  std::vector<bool> loop_blocks(blocks.size(), false);
+  for (size_t id = 0; id < block_records.size(); id++) {
+    auto& block_record = block_records[id];
+    auto& framework_block = blocks[id];
+    if (block_record.block == kNone) continue;
+
+    loop_blocks[id] = block_record.flags & LOOP_BLOCK;
+    for (auto& inst : values(block_record.instructions)) {
+      if (!inst || !framework::shared_isa<framework::Instruction>(inst)) {
+        failed_ = true;
+        return;
+      }
+      framework_block->addInstruction(
+          std::static_pointer_cast<framework::Instruction>(inst));
+    }
+    if (auto branch = value(block_record.branch)) {
+      if (!framework::shared_isa<framework::BranchInst>(branch)) {
+        failed_ = true;
+        return;
+      }
+      framework_block->setBranchInst(
+          std::static_pointer_cast<framework::BranchInst>(branch));
+    }
+    for (auto& dead_value : values(block_record.dead_values))
+      framework_block->addDeadValue(dead_value);
+    for (auto& pass_through :
+         records(reader_.pairs_, block_record.pass_through))
+      framework_block->addPassthroughBlock(block(pass_through.first),
+                                           block(pass_through.second));
+  }
+  if (record.flags & LOOP_INFO) function->setLoopBlocks(loop_blocks);
+  function->setLoopBackBlock(record.flags & LOOP_BACK);
+
+  auto edges = [this, &blocks](Range range) {
+    std::vector<std::pair<uint32_t, uint32_t>> loaded;
+    for (auto& edge : records(reader_.pairs_, range)) {
+      if (edge.first >= blocks.size() || edge.second >= blocks.size() ||
+          !blocks[edge.first] || !blocks[edge.second]) {
+        failed_ = true;
+        break;
+      }
+      loaded.push_back({edge.first, edge.second});
+    }
+    return loaded;
+  };
+  function->setEdges(edges(record.successors), edges(record.predecessors));
+
+  function->setReturnValue(value(record.return_value));
+  if (auto return_block = block(record.return_block))
+    function->setReturnBlock(return_block);
+  for (auto& assignment : records(reader_.pairs_, record.return_assignments))
+    function->addPossibleReturnValues(value(assignment.second),
+                                      block(assignment.first));
+
+  for (auto caller : records(reader_.refs_, record.callers)) {
+    auto llvm_caller =
+        llvm::dyn_cast_or_null<llvm::Function>(index_.value(caller));
+    if (!llvm_caller) {
+      failed_ = true;
+      return;
+    }
+    function->addCallerFunction(
+        framework::Function::createManagedFunction(llvm_caller));
+  }
+
+  function->setProtectedRefcountValue(value(record.protected_refcount_value));
+  if (auto last_refcount_call = value(record.last_refcount_call)) {
+    if (!framework::shared_isa<framework::Instruction>(last_refcount_call)) {
+      failed_ = true;
+      return;
+    }
+    function->addRefcountInstruction(
+        std::static_pointer_cast<framework::Instruction>(last_refcount_call));
+  }
+
+  if (!failed_) function->buildCFG();
+}
+
+bool SnapshotReader::loadFrameworkIR(
+    llvm::Module& M, framework::AnalysisContext& context) const {
+  if (!hasFrameworkIR()) return false;
+
+  framework::AnalysisContext::Scope scope(context);
+  Loader loader(*this, M);
+  if (loader.load(context)) return true;
+
+  llvm::errs() << "[Snapshot] the framework IR of " << M.getModuleIdentifier()
+               << " does not match its bitcode, it is generated again\n";
+  context.clear();
+  return false;
+}
+}  // namespace snapshot
+}  // namespace ir_generator
@@ -30,8 +30,13 @@
 // include STL
 #include <llvm/IR/Instructions.h>
 #include <llvm/Support/raw_ostream.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include <algorithm>
+#include <cerrno>
+#include <chrono>
 #include <ctime>
 #include <iostream>
 #include <iterator>
@@ -49,24 +54,303 @@
 #include "framework_ir/IRGenerator.hpp"
 #include "frontend/Analyzer.hpp"
 #include "frontend/CommandlineArgs.hpp"
+#include "frontend/Daemon.hpp"
 #include "frontend/Function.hpp"
+#include "frontend/Jobserver.hpp"
+#include "frontend/MemoryGovernor.hpp"
 #include "frontend/PropagationConstraint.hpp"
+#include "frontend/Supervisor.hpp"
+#include "frontend/Tabulation.hpp"
+#include "frontend/ValueLiveness.hpp"
+#include "frontend/ValuePartition.hpp"
 
 namespace framework {
+static constexpr auto kPartitionPollInterval = std::chrono::milliseconds(500);
+
 Analyzer::Analyzer(llvm::Module &llvm_module,
                    framework::StateManager &state_manager,
-                   framework::LoggingClient &client)
-    : llvm_module_(llvm_module), state_manager_(state_manager), log_(client) {}
+                   framework::LoggingClient &client,
+                   framework::AnalysisContext &context)
+    : llvm_module_(llvm_module),
+      state_manager_(state_manager),
+      log_(client),
+      context_(context),
+      transition_tables_(state_manager.getStates()) {
+  if (framework::CommandLineArgs::ScanCandidates)
+    candidate_scan_ = std::make_unique<CandidateScan>(state_manager_);
+}
+
+bool Analyzer::skipFunction(std::shared_ptr<framework::Function> function) {
+  if (candidate_filter_ && !candidate_filter_(function)) return true;
+  return candidate_scan_ && !candidate_scan_->isCandidate(function);
+}
 
 void Analyzer::analyze() {
-  auto &framework_ir = ir_generator::IRGenerator::framework_ir_;
-  if (framework_ir.find(&llvm_module_) == framework_ir.end()) return;
-  for (auto function : framework_ir[&llvm_module_]) {
-    analyzeFunction(function);
+  AnalysisContext::Scope scope(context_);
+  if (!context_.hasFrameworkIR(&llvm_module_)) return;
+  auto &functions = context_.FrameworkIR(&llvm_module_);
+  if (!framework::CommandLineArgs::QueryLocation.empty()) {
+    query(framework::CommandLineArgs::QueryLocation,
+          {functions.begin(), functions.end()});
+    return;
+  }
+  if (framework::CommandLineArgs::Ifds) {
+    tabulate({functions.begin(), functions.end()});
+    reportAccessPaths();
+    return;
+  }
+  for (auto function : functions) {
+    if (skipFunction(function)) continue;
+    if (!analyzePartitioned(function)) analyzeFunction(function);
+    // Reports are handed over per function, so that they survive an
+    // analyzer killed later on
+    if (progress_) log_.flush();
   }
+  reportAccessPaths();
   log_.flush();
 }
 
+void Analyzer::analyze(
+    const std::vector<std::shared_ptr<framework::Function>>& functions) {
+  AnalysisContext::Scope scope(context_);
+  if (framework::CommandLineArgs::Ifds) {
+    tabulate(functions);
+    return;
+  }
+  for (auto function : functions) {
+    if (skipFunction(function)) continue;
+    if (!analyzePartitioned(function)) analyzeFunction(function);
+    if (progress_) log_.flush();
+  }
+  log_.flush();
+}
+
+// Each worker runs the fixpoint of the function on its part of the values
+// only, and the reports are merged in the order of the parts. The function
+// has no callers, so the parent does not need the states of the other parts.
+// Like the analyzer processes, a worker needs a jobserver token and its
+// memory, which this process hands back once the worker is reaped.
+bool Analyzer::analyzePartitioned(
+    std::shared_ptr<framework::Function> function) {
+  if (!framework::CommandLineArgs::PartitionBlocks ||
+      framework::CommandLineArgs::PartitionJobs < 2 ||
+      function->BasicBlocks().size() <
+          framework::CommandLineArgs::PartitionBlocks ||
+      !function->CallerFunctions().empty() ||
+      functionInformationExists(function))
+    return false;
+
+  auto partition = std::make_unique<ValuePartition>(
+      function, framework::CommandLineArgs::PartitionJobs);
+  if (partition->Parts() < 2) return false;
+
+  // The callees are analyzed once here rather than in every worker
+  for (auto &block : function->OrderedBasicBlocks()) {
+    for (auto &inst : block->Instructions()) {
+      auto call_inst = shared_dyn_cast<framework::CallInst>(inst);
+      if (!call_inst || !call_inst->CalledFunction() ||
+          call_inst->CalledFunction()->isDeclaration())
+        continue;
+      analyzeFunction(call_inst->CalledFunction());
+    }
+  }
+
+  struct Worker {
+    pid_t process_id;
+    int fd;
+    bool token;
+    int reservation;
+  };
+  Jobserver jobserver;
+  MemoryGovernor governor(memory_budget_);
+  uint64_t units = 0;
+  for (auto &block : function->OrderedBasicBlocks())
+    units += block->Instructions().size();
+  uint64_t estimate = governor.estimate(units);
+  auto release = [&jobserver, &governor](const Worker &worker) {
+    if (worker.token) jobserver.release();
+    governor.release(worker.reservation, 0, 0);
+  };
+
+  // The parts that cannot be forked are analyzed here along with the first
+  std::set<size_t> local_parts = {0};
+  std::vector<Worker> workers;
+  for (size_t part = 1; part < partition->Parts(); part++) {
+    Worker worker = {-1, -1, false, MemoryGovernor::kNoReservation};
+    if (jobserver.active() && !jobserver.acquire()) {
+      local_parts.insert(part);
+      continue;
+    }
+    worker.token = jobserver.active();
+    worker.reservation =
+        governor.reserve(estimate, std::chrono::milliseconds(0));
+    if (governor.active() &&
+        worker.reservation == MemoryGovernor::kNoReservation) {
+      release(worker);
+      local_parts.insert(part);
+      continue;
+    }
+
+    int fd[2];
+    if (pipe(fd) < 0) {
+      release(worker);
+      local_parts.insert(part);
+      continue;
+    }
+
+    pid_t process_id = fork();
+    if (process_id == 0) {
+      close(fd[0]);
+      Supervisor::closeWorkerPipes();
+      log_.takeBuffer();
+      // The reports keep their keys on the way to the parent
+      std::string records;
+      log_.setReportCallback([&records](const LoggingClient::Report &report) {
+        records += LoggingClient::encodeReport(report);
+      });
+      progress_ = nullptr;
+      partitioned_function_ = function;
+      value_partition_ = std::move(partition);
+      partitions_ = {part};
+      analyzeFunction(function);
+
+      records += LoggingClient::encodeReport({"", log_.takeBuffer()});
+      if (!daemon::writeAll(fd[1], records.data(), records.size())) exit(1);
+      exit(0);
+    }
+    close(fd[1]);
+    if (process_id < 0) {
+      close(fd[0]);
+      release(worker);
+      local_parts.insert(part);
+      continue;
+    }
+    worker.process_id = process_id;
+    worker.fd = fd[0];
+    workers.push_back(worker);
+  }
+
+  partitioned_function_ = function;
+  value_partition_ = std::move(partition);
+  partitions_ = local_parts;
+  analyzeFunction(function);
+  partitioned_function_ = nullptr;
+  value_partition_.reset();
+
+  // The workers are read as they write. Their progress is reported as this
+  // process's own, so that a supervisor does not take it as stalled.
+  std::vector<std::string> records(workers.size());
+  std::vector<struct pollfd> fds;
+  for (auto &worker : workers) fds.push_back({worker.fd, POLLIN, 0});
+  size_t open_workers = workers.size();
+  while (open_workers > 0) {
+    reportProgress(function);
+    int result = poll(fds.data(), fds.size(), kPartitionPollInterval.count());
+    if (result < 0 && errno != EINTR) break;
+    if (result <= 0) continue;
+
+    for (size_t i = 0; i < workers.size(); i++) {
+      if (fds[i].fd < 0 || !fds[i].revents) continue;
+      char buffer[4096];
+      ssize_t size = read(fds[i].fd, buffer, sizeof(buffer));
+      if (size < 0 && errno == EINTR) continue;
+      if (size > 0) {
+        records[i].append(buffer, size);
+        continue;
+      }
+      fds[i].fd = -1;
+      open_workers--;
+    }
+  }
+
+  for (size_t i = 0; i < workers.size(); i++) {
+    for (auto &report : LoggingClient::decodeReports(records[i])) {
+      if (report.key.empty())
+        log_.log(report.text);
+      else
+        log_.report(report);
+    }
+    close(workers[i].fd);
+    waitpid(workers[i].process_id, nullptr, 0);
+    release(workers[i]);
+  }
+  return true;
+}
+
+bool Analyzer::inPartition(std::shared_ptr<framework::Value> value) {
+  return !partitioned_function_ ||
+         currentFunctionInformation()->Function() != partitioned_function_ ||
+         partitions_.count(value_partition_->PartOf(*value));
+}
+
+// The counts cover the values built by the IR generator and this analyzer
+void Analyzer::reportAccessPaths() {
+  if (!framework::CommandLineArgs::AccessPathStats) return;
+  auto &stats = Value::PathStats();
+  llvm::raw_string_ostream log_stream = log_.raw_stream();
+  log_stream << "[Access Paths] (" << llvm_module_.getName() << ") "
+             << stats.truncated << " of " << stats.paths
+             << " paths cut at depth " << Value::AccessPathDepth() << "\n";
+}
+
+// The values in a bug state reported at the end of the function or the module
+// are kept for it
+void Analyzer::pruneDeadValues(std::shared_ptr<framework::BasicBlock> block) {
+  auto liveness = currentFunctionInformation()->getValueLiveness();
+  if (!liveness) return;
+
+  bb_info_->ValueStates().removeValues(
+      [&liveness, &block](const std::shared_ptr<framework::Value> &value,
+                          const TransitionLogs &logs) {
+        if (logs.isDummy()) return false;
+        auto &state = logs.CurrentState();
+        if (state.isBugState() &&
+            state.NotificationTiming() != BugNotificationTiming::IMMEDIATE)
+          return false;
+        return !liveness->isLiveOut(block, *value);
+      });
+}
+
+// The callees of the entry points are solved along with them, whether they
+// are candidates or not
+void Analyzer::tabulate(
+    const std::vector<std::shared_ptr<framework::Function>>& functions) {
+  std::vector<std::shared_ptr<framework::Function>> entries;
+  std::copy_if(functions.begin(), functions.end(), std::back_inserter(entries),
+               [this](auto& function) { return !skipFunction(function); });
+  TabulationSolver(state_manager_, log_, framework::CommandLineArgs::Flex)
+      .solve(entries);
+  log_.flush();
+}
+
+bool Analyzer::query(
+    const std::string &location,
+    const std::vector<std::shared_ptr<framework::Function>> &functions) {
+  std::string bug_states;
+  for (auto &state : state_manager_.getBugStates())
+    bug_states += (bug_states.empty() ? "" : ", ") + state.Name();
+
+  Query query(location);
+  if (query.isValid()) query.collect(functions);
+  if (query.Instructions().empty()) {
+    log_.log("[QUERY] " + location + " [" + bug_states +
+             "]: no instruction found\n");
+    log_.flush();
+    return false;
+  }
+
+  TabulationSolver solver(state_manager_, log_,
+                          framework::CommandLineArgs::Flex);
+  solver.setQuery(&query);
+  solver.solve(query.Entries());
+
+  log_.log("[QUERY] " + location + " [" + bug_states + "]: " +
+           (solver.Reports() ? "bug state reachable\n"
+                             : "no bug state reachable\n"));
+  log_.flush();
+  return solver.Reports();
+}
+
 void Analyzer::analyzeFunction(std::shared_ptr<framework::Function> function) {
   // Add new FunctionInformation Class
   if (!functionInformationExists(function))
@@ -77,16 +361,32 @@ void Analyzer::analyzeFunction(std::shared_ptr<framework::Function> function) {
   if (func_info->Stat() != FunctionInformation::UNANALYZED) return;
   func_info->setAnalysisStat(
       framework::FunctionInformation::AnalysisStat::IN_PROGRESS);
+  if (progress_) {
+    progress_(function);
+    last_progress_ = std::chrono::steady_clock::now();
+  }
 
   analyzing_function_.push(function);
   /* auto target_blocks = function->BasOrderedicBlocks(); */
   auto target_blocks = function->OrderedBasicBlocks();
+  if (framework::CommandLineArgs::SparseStates) {
+    auto graph = std::make_shared<StateFlowGraph>(
+        function,
+        !state_manager_.TransitionManager()->getUseValueTransitions().empty());
+    func_info->setStateFlowGraph(graph);
+    target_blocks = graph->Nodes();
+  }
+  if (framework::CommandLineArgs::PruneDeadValues)
+    func_info->setValueLiveness(std::make_shared<ValueLiveness>(function));
 
   std::queue<std::shared_ptr<framework::BasicBlock>> block_queue(
       std::deque(target_blocks.begin(), target_blocks.end()));
 
   while (!block_queue.empty()) {
+    if (overBudget(func_info)) break;
     auto block = block_queue.front();
+    func_info->countStep();
+    reportProgress(function);
     bb_info_ =
         func_info->createBasicBlockInfo(block, state_manager_.getStates());
     func_info->setAnayzingBasicBlock(block);
@@ -115,6 +415,26 @@ void Analyzer::analyzeFunction(std::shared_ptr<framework::Function> function) {
 
     generateError(BugNotificationTiming::IMMEDIATE);
     generateError(BugNotificationTiming::END_OF_LIFE, block->DeadValues());
+    pruneDeadValues(block);
+  }
+
+  // The partial states are not reliable at the function end, and the
+  // callers fall back to treating the function as a declaration
+  if (overBudget(func_info)) {
+    llvm::raw_string_ostream log_stream = log_.raw_stream();
+    log_stream << "[WARNING] " << function->Name()
+               << ": analysis budget exceeded ("
+               << framework::CommandLineArgs::FunctionBudget
+               << " steps), summarized conservatively\n";
+
+    analyzing_function_.pop();
+    func_info->setAnalysisStat(
+        framework::FunctionInformation::AnalysisStat::OVER_BUDGET);
+    if (framework::CommandLineArgs::ReleaseFunctionStates) {
+      bb_info_.reset();
+      func_info->releaseAnalysisState();
+    }
+    return;
   }
 
   analyzeReturnValue(function);
@@ -130,14 +450,16 @@ void Analyzer::analyzeFunction(std::shared_ptr<framework::Function> function) {
   analyzing_function_.pop();
   func_info->setAnalysisStat(
       framework::FunctionInformation::AnalysisStat::ANALYZED);
+  if (framework::CommandLineArgs::ReleaseFunctionStates) {
+    bb_info_.reset();
+    func_info->releaseAnalysisState();
+  }
 }
 
 void Analyzer::analyzePrevBlockBranch(
     std::shared_ptr<framework::BasicBlock> block) {
-  for (auto pred_reference : block->Predecessors()) {
-    auto preds = pred_reference.lock();
-    if (!preds ||
-        !currentFunctionInformation()->getBasicBlockInformation(preds))
+  for (auto& preds : block->Predecessors()) {
+    if (!currentFunctionInformation()->getBasicBlockInformation(preds))
       continue;
     /* auto passthrough_blocks = */
     /*     std::vector<std::shared_ptr<framework::BasicBlock>>(); */
@@ -153,22 +475,10 @@ void Analyzer::analyzePrevBlockBranch(
 
     /* for (auto passed_block : passthrough_blocks) { */
     auto branch_inst = preds->getBranchInst();
-    if (!branch_inst || !branch_inst->Condition()) continue;
+    if (!branch_inst) continue;
 
-    auto condition_inst =
-        shared_dyn_cast<framework::CompareInst>(branch_inst->Condition());
-    if (!condition_inst) continue;
-
-    bool null_exists = false;
-    std::shared_ptr<framework::Value> comp_value = nullptr;
-    for (auto operand : condition_inst->Operands()) {
-      if (shared_isa<framework::NullValue>(operand)) {
-        null_exists = true;
-        continue;
-      }
-      if (shared_isa<framework::ConstValue>(operand)) continue;
-      comp_value = operand;
-    }
+    auto &facts = branch_inst->Facts();
+    auto comp_value = facts.compared_value;
     if (!comp_value) continue;
 
     auto call_inst = shared_dyn_cast<CallInst>(comp_value);
@@ -178,15 +488,10 @@ void Analyzer::analyzePrevBlockBranch(
         generateWarning(call_inst.get(), args.get());
     }
 
-    if (!null_exists) continue;
-    BranchInst::TransitionNodes null_nodes =
-        condition_inst->GetPredicate() == llvm::CmpInst::ICMP_EQ
-            ? branch_inst->TruePathNodes()
-            : branch_inst->FalsePathNodes();
+    auto edge = branch_inst->getEdgeFacts(block);
+    if (!edge || edge->refinement == EdgeFacts::NONE) continue;
     StoreValueTransitionRule::StoreValueType type =
-        std::find_if(null_nodes.begin(), null_nodes.end(),
-                     [&block](auto node) { return node.lock() == block; }) !=
-                null_nodes.end()
+        edge->refinement == EdgeFacts::NULL_PATH
             ? StoreValueTransitionRule::NULL_BRANCH_CONSIDERED_NULL
             : StoreValueTransitionRule::NULL_BRANCH_CONSIDERED_NON_NULL;
 
@@ -214,9 +519,7 @@ void Analyzer::analyzePrevBlockBranch(
     }
 
     generateWarning(branch_inst.get(), "Branch Inst Transition");
-    for (auto value : related_values) {
-      changeValueState(transitions, value, branch_inst);
-    }
+    changeValueStates(transitions, related_values, branch_inst);
     generateWarning(branch_inst.get(), "Branch Inst Transition Done");
 
     // Additionally remove corresponding ret val for semantic correspondness
@@ -240,15 +543,7 @@ void Analyzer::analyzeCallInst(std::shared_ptr<framework::Instruction> I) {
   auto function = call_inst->CalledFunction();
   if (!function) {
     // This is an indirect call. Should deal like its being outed
-    for (auto value : call_inst->Arguments()) {
-      std::set<std::shared_ptr<framework::Value>> related_values =
-          currentFunctionInformation()->GetValueCollection().getRelatedValues(
-              value);
-      related_values.insert(value);
-      for (auto &related : related_values) {
-        bb_info_->removeValueFromState(related, I);
-      }
-    }
+    escapeArguments(call_inst);
     return;
   }
 
@@ -286,9 +581,7 @@ void Analyzer::analyzeCallInst(std::shared_ptr<framework::Instruction> I) {
             call_inst->Arguments()[0]);
     related_values.insert(call_inst->Arguments()[0]);
 
-    for (auto value : related_values) {
-      changeValueState(transitions, value, I);
-    }
+    changeValueStates(transitions, related_values, I);
     return;
   }
 
@@ -296,15 +589,7 @@ void Analyzer::analyzeCallInst(std::shared_ptr<framework::Instruction> I) {
     /* for (auto value : call_inst->Arguments()) { */
     /*   bb_info_->removeValueFromState(value, I); */
     /* } */
-    for (auto value : call_inst->Arguments()) {
-      std::set<std::shared_ptr<framework::Value>> related_values =
-          currentFunctionInformation()->GetValueCollection().getRelatedValues(
-              value);
-      related_values.insert(value);
-      for (auto &related : related_values) {
-        bb_info_->removeValueFromState(related, I);
-      }
-    }
+    escapeArguments(call_inst);
   } else {
     if (state_manager_.getStatefulConstraint() &&
         !state_manager_.getStatefulConstraint()->shouldPropagateOnCallInst(
@@ -314,10 +599,28 @@ void Analyzer::analyzeCallInst(std::shared_ptr<framework::Instruction> I) {
     analyzeFunction(function);
     bb_info_ = function_info_[analyzing_function_.top()]
                    ->getCurrentBasicBlockInformation();
+
+    // A callee summarized on the budget is treated like a declaration
+    if (function_info_[function]->Stat() == FunctionInformation::OVER_BUDGET) {
+      escapeArguments(call_inst);
+      return;
+    }
     copyFunctionValues(function, call_inst);
   }
 }
 
+void Analyzer::escapeArguments(std::shared_ptr<framework::CallInst> call_inst) {
+  for (auto value : call_inst->Arguments()) {
+    std::set<std::shared_ptr<framework::Value>> related_values =
+        currentFunctionInformation()->GetValueCollection().getRelatedValues(
+            value);
+    related_values.insert(value);
+    for (auto &related : related_values) {
+      bb_info_->removeValueFromState(related, call_inst);
+    }
+  }
+}
+
 void Analyzer::analyzeStoreInst(std::shared_ptr<framework::Instruction> I) {
   auto store_inst = std::static_pointer_cast<framework::StoreInst>(I);
   std::vector<framework::Transition> transitions;
@@ -364,9 +667,7 @@ void Analyzer::analyzeStoreInst(std::shared_ptr<framework::Instruction> I) {
           store_inst->PointerOperand());
   related_values.insert(store_inst->PointerOperand());
 
-  for (auto value : related_values) {
-    changeValueState(transitions, value, I);
-  }
+  changeValueStates(transitions, related_values, I);
 
   checkAlias(store_inst);
 }
@@ -409,11 +710,8 @@ void Analyzer::checkAlias(std::shared_ptr<framework::StoreInst> store_inst) {
     related_values.insert(values.begin(), values.end());
   }
 
-  auto possible_transitions =
-      state_manager_.TransitionManager()->getAliasTransitions();
-  for (auto value : related_values) {
-    changeValueState(possible_transitions, value, store_inst);
-  }
+  changeValueStates(state_manager_.TransitionManager()->getAliasTransitions(),
+                    related_values, store_inst);
 }
 
 void Analyzer::analyzeLoadInst(std::shared_ptr<framework::Instruction> I) {
@@ -429,10 +727,26 @@ bool Analyzer::functionInformationExists(
   return function_info_.find(function) != function_info_.end();
 }
 
+bool Analyzer::overBudget(std::shared_ptr<FunctionInformation> func_info) {
+  return framework::CommandLineArgs::FunctionBudget &&
+         func_info->Steps() > framework::CommandLineArgs::FunctionBudget;
+}
+
+void Analyzer::reportProgress(std::shared_ptr<framework::Function> function) {
+  if (!progress_) return;
+
+  auto now = std::chrono::steady_clock::now();
+  if (now - last_progress_ < std::chrono::seconds(1)) return;
+  last_progress_ = now;
+  progress_(function);
+}
+
 void Analyzer::changeValueState(std::vector<Transition> transitions,
                                 std::shared_ptr<Value> value,
                                 std::shared_ptr<framework::Instruction> inst) {
-  if (value->isGlobalVar() || transitions.empty()) return;
+  if (value->isGlobalVar() || transitions.empty() || !inPartition(value))
+    return;
+  currentFunctionInformation()->countStep();
   if (currentFunctionInformation()
           ->getCurrentBasicBlockInformation()
           ->changeValueState(transitions, value, inst)) {
@@ -443,6 +757,34 @@ void Analyzer::changeValueState(std::vector<Transition> transitions,
   }
 }
 
+void Analyzer::changeValueStates(
+    std::vector<Transition> transitions,
+    const std::set<std::shared_ptr<Value>> &values,
+    std::shared_ptr<framework::Instruction> inst) {
+  if (transitions.empty()) return;
+  TransitionTable &table = transition_tables_.get(transitions);
+  if (!table.isValid()) {
+    for (auto &value : values) changeValueState(transitions, value, inst);
+    return;
+  }
+
+  std::set<std::shared_ptr<Value>> local_values;
+  for (auto &value : values) {
+    if (value->isGlobalVar() || !inPartition(value)) continue;
+    currentFunctionInformation()->countStep();
+    local_values.insert(value);
+  }
+
+  for (auto &value : currentFunctionInformation()
+                         ->getCurrentBasicBlockInformation()
+                         ->changeValueStates(table, local_values, inst)) {
+    currentFunctionInformation()->addValue(value);
+    framework::generateWarning(inst.get(),
+                               "[Value Change] Change Value State: ");
+    framework::generateWarning(inst.get(), value.get());
+  }
+}
+
 void Analyzer::generateError(
     BugNotificationTiming timing,
     const std::set<std::shared_ptr<framework::Value>> values) {
@@ -450,6 +792,9 @@ void Analyzer::generateError(
     if (state.NotificationTiming() != timing) continue;
     for (auto value : bb_info_->getValueTransitionStates(state)) {
       if (!values.empty() && values.find(value.first) == values.end()) continue;
+      // Reached through the pending states of a call, but reported by the
+      // part it belongs to
+      if (!inPartition(value.first)) continue;
       if (value.second->CurrentState() != state) continue;
       if (!value.second->LeastSignificantSource().isInitState()) continue;
       /* if (!value.second->ReducedTransition().Source().isInitState()) continue; */
@@ -462,14 +807,16 @@ void Analyzer::generateError(
 
       if (framework::CommandLineArgs::Flex ||
           !value.first->isArbitaryArrayElement()) {
-        llvm::raw_string_ostream log_stream = log_.raw_stream();
-        framework::generateError(log_stream,
-                                 value.second->CurrentInstruction().get(),
+        auto inst = value.second->CurrentInstruction().get();
+        std::string text;
+        llvm::raw_string_ostream text_stream(text);
+        framework::generateError(text_stream, inst,
                                  "--- [" + state.Name() + "] ---");
-        framework::generateError(log_stream,
-                                 value.second->CurrentInstruction().get(),
-                                 value.first.get());
-        value.second->generateLog(log_stream);
+        framework::generateError(text_stream, inst, value.first.get());
+        value.second->generateLog(text_stream);
+        log_.report(
+            {framework::reportKey(inst, state.Name(), value.first.get()),
+             text_stream.str()});
       }
       value.second->logicalTerminate(value.second->CurrentInstruction());
     }
@@ -501,11 +848,10 @@ void Analyzer::copyFunctionValues(
   for (auto success_block_ref : success_blocks) {
     auto success_block = success_block_ref.lock();
     if (!success_block) continue;
-    auto basic_block_info =
-        called_func_info->getBasicBlockInformation(success_block);
+    auto arg_states = called_func_info->getReturnArgValueStates(success_block);
 
-    if (!basic_block_info) continue;
-    pending_states.addArgValueState(basic_block_info->getArgValueStates());
+    if (!arg_states) continue;
+    pending_states.addArgValueState(*arg_states);
 
     /* llvm::errs() << "=== :(\n"; */
     /* auto operands = call_inst->Arguments(); */
@@ -547,36 +893,18 @@ bool Analyzer::addPendingFunctionValues(
 
   generateWarning(call_inst.get(), "Found BranchInst");
 
-  int compared_value = framework::FunctionInformation::kSuccessCode;
-  llvm::CmpInst::Predicate predicate = llvm::CmpInst::Predicate::ICMP_NE;
-  bool is_null_value = false;
-
-  if (auto compare_inst = framework::shared_dyn_cast<framework::CompareInst>(
-          branch_inst->Condition())) {
-    if (!compare_inst->operandExists(call_inst)) {
-      return false;
-    }
-    generateWarning(call_inst.get(), "Found CompareInst");
-
-    predicate = compare_inst->GetPredicate();
-
-    auto operand = std::find_if(
-        compare_inst->Operands().begin(), compare_inst->Operands().end(),
-        [call_inst](auto operand) { return operand != call_inst; });
-
-    if (operand == compare_inst->Operands().end()) return false;
+  auto &facts = branch_inst->Facts();
+  if (std::none_of(facts.calls.begin(), facts.calls.end(),
+                   [&call_inst](auto &compared_call) {
+                     return compared_call->LLVMInstruction() ==
+                            call_inst->LLVMInstruction();
+                   }))
+    return false;
+  generateWarning(call_inst.get(), "Found compared call");
 
-    if (auto const_value =
-            framework::shared_dyn_cast<framework::ConstValue>(*operand)) {
-      compared_value = const_value->getConstValue();
-    } else if (framework::shared_isa<framework::NullValue>(*operand)) {
-      is_null_value = true;
-    }
-  } else if (framework::shared_isa<framework::CallInst>(
-                 branch_inst->Condition())) {
-    if (call_inst != branch_inst->Condition()) return false;
-    generateWarning(call_inst.get(), "Found Call Inst instead");
-  }
+  int compared_value = facts.compared_constant;
+  llvm::CmpInst::Predicate predicate = facts.predicate;
+  bool is_null_value = facts.null_operand;
 
   if (!functionInformationExists(called_func)) return false;
   auto called_func_info = function_info_[called_func];
@@ -619,31 +947,32 @@ bool Analyzer::addPendingFunctionValues(
     generateWarning(call_inst.get(),
                     is_false_path ? "True Path" : "False Path");
 
-    BranchInst::TransitionNodes nodes = is_false_path
-                                            ? branch_inst->TruePathNodes()
-                                            : branch_inst->FalsePathNodes();
-    for (auto successor_node : nodes) {
+    for (auto& successor :
+         currentFunctionInformation()->currentBasicBlock()->Successors()) {
+      auto edge = branch_inst->getEdgeFacts(successor);
+      if (!edge || !(is_false_path ? edge->true_path : edge->false_path))
+        continue;
+
       auto ret_value = std::make_shared<framework::ConstValue>(ret.first);
-      auto locked = successor_node.lock();
       for (auto success_block_ref : ret.second) {
         auto success_block = success_block_ref.lock();
         if (!success_block) continue;
-        auto success_basic_block_info =
-            called_func_info->getBasicBlockInformation(success_block);
+        auto success_arg_states =
+            called_func_info->getReturnArgValueStates(success_block);
 
         if (!success_block->Instructions().empty())
           generateWarning(success_block->Instructions().front().get(),
                           "Pred Blocks");
 
-        if (!locked->Instructions().empty())
-          generateWarning(locked->Instructions().front().get(),
+        if (!successor->Instructions().empty())
+          generateWarning(successor->Instructions().front().get(),
                           "Propagating Block");
 
-        if (!success_basic_block_info) continue;
+        if (!success_arg_states) continue;
 
-        basic_block_info->setPendingValueStates(
-            successor_node, success_basic_block_info->getArgValueStates());
-        basic_block_info->setPendingReturnValues(successor_node, ret_value);
+        basic_block_info->setPendingValueStates(successor,
+                                                *success_arg_states);
+        basic_block_info->setPendingReturnValues(successor, ret_value);
       }
     }
   }
@@ -675,9 +1004,7 @@ bool Analyzer::analyzeFunctionCall(
 
     args.insert(call_inst->Arguments()[arg]);
 
-    for (auto &value : args) {
-      changeValueState(transitions.second, value, call_inst);
-    }
+    changeValueStates(transitions.second, args, call_inst);
   }
   return changed;
 }
@@ -694,8 +1021,8 @@ void Analyzer::analyzeReturnValue(
     return;
   }
 
-  std::set<std::weak_ptr<framework::BasicBlock>> pred_block(
-      return_block->Predecessors());
+  std::vector<std::shared_ptr<framework::BasicBlock>> pred_block(
+      return_block->Predecessors().begin(), return_block->Predecessors().end());
 
   /* if (pred_block.empty() || !return_block->Instructions().empty()) { */
   /*   pred_block.insert(return_block); */
@@ -706,75 +1033,73 @@ void Analyzer::analyzeReturnValue(
   }
 
   if (pred_block.empty()) {
-    pred_block.insert(return_block);
+    pred_block.push_back(return_block);
   }
 
-  for (auto pred_reference : pred_block) {
-    if (auto pred = pred_reference.lock()) {
-      if (!pred->Instructions().empty()) {
-        generateWarning(pred->Instructions().front().get(),
-                        "Pred Block analysis");
-      }
+  for (auto pred : pred_block) {
+    if (!pred->Instructions().empty()) {
+      generateWarning(pred->Instructions().front().get(),
+                      "Pred Block analysis");
+    }
 
-      auto block_info = func_info->getBasicBlockInformation(pred);
-      if (!block_info) continue;
-      if (block_info->ReturnValues().empty()) {
-        func_info->addReturnValueInfo(FunctionInformation::kSuccessCode, pred);
-        func_info->addReturnValueInfo(FunctionInformation::kErrorCode, pred);
-        continue;
-      }
+    auto block_info = func_info->getBasicBlockInformation(pred);
+    if (!block_info) continue;
+    if (block_info->ReturnValues().empty()) {
+      func_info->addReturnValueInfo(FunctionInformation::kSuccessCode, pred);
+      func_info->addReturnValueInfo(FunctionInformation::kErrorCode, pred);
+      continue;
+    }
 
-      for (auto return_value : block_info->ReturnValues()) {
-        if (auto const_int = framework::shared_dyn_cast<framework::ConstValue>(
-                return_value)) {
-          auto value = const_int->getConstValue();
-          generateWarning(std::to_string(value));
-          if (block_info->ReturnValueSatisfiable(value))
-            func_info->addReturnValueInfo(value, pred);
-        } else if (auto const_null =
-                       framework::shared_dyn_cast<framework::NullValue>(
-                           return_value)) {
-          func_info->addReturnValueInfo(FunctionInformation::kErrorCode, pred);
-          // Add the value to the list
-        } else if (auto call_inst =
-                       framework::shared_dyn_cast<framework::CallInst>(
-                           return_value)) {
-          auto called_function = call_inst->CalledFunction();
-          if (called_function) {
-            if (called_function->isErrorFunction()) {
-              func_info->addReturnValueInfo(FunctionInformation::kErrorCode,
-                                            pred);
-              continue;
-            }
-
-            auto called_func_info = getFunctionInformation(called_function);
-            if (!called_func_info) {
-              /* func_info->addReturnValueInfo(FunctionInformation::kErrorCode,
-               */
-              /*                               pred); */
-              /* func_info->addReturnValueInfo(FunctionInformation::kSuccessCode,
-               */
-              /*                               pred); */
-              continue;
-            }
-
-            for (auto return_value : called_func_info->getReturnValueInfo()) {
-              /* func_info->addReturnValueInfo(return_value.first, */
-              /*                               return_value.second); */
-              if (block_info->ReturnValueSatisfiable(return_value.first))
-                func_info->addReturnValueInfo(return_value.first, pred);
-            }
-          }
-          // Decode the call_inst by chaning
-        } else {
-          if (return_value->getValueID() > 0) {
-            func_info->addReturnValueInfo(FunctionInformation::kSuccessCode,
-                                          pred);
+    for (auto return_value : block_info->ReturnValues()) {
+      if (auto const_int = framework::shared_dyn_cast<framework::ConstValue>(
+              return_value)) {
+        auto value = const_int->getConstValue();
+        generateWarning(std::to_string(value));
+        if (block_info->ReturnValueSatisfiable(value))
+          func_info->addReturnValueInfo(value, pred);
+      } else if (auto const_null =
+                     framework::shared_dyn_cast<framework::NullValue>(
+                         return_value)) {
+        func_info->addReturnValueInfo(FunctionInformation::kErrorCode, pred);
+        // Add the value to the list
+      } else if (auto call_inst =
+                     framework::shared_dyn_cast<framework::CallInst>(
+                         return_value)) {
+        auto called_function = call_inst->CalledFunction();
+        if (called_function) {
+          if (called_function->isErrorFunction()) {
             func_info->addReturnValueInfo(FunctionInformation::kErrorCode,
                                           pred);
+            continue;
+          }
+
+          auto called_func_info = getFunctionInformation(called_function);
+          if (!called_func_info) {
+            /* func_info->addReturnValueInfo(FunctionInformation::kErrorCode,
+             */
+            /*                               pred); */
+            /* func_info->addReturnValueInfo(FunctionInformation::kSuccessCode,
+             */
+            /*                               pred); */
+            continue;
+          }
+
+          for (auto return_value : called_func_info->getReturnValueInfo()) {
+            /* func_info->addReturnValueInfo(return_value.first, */
+            /*                               return_value.second); */
+            if (block_info->ReturnValueSatisfiable(return_value.first))
+              func_info->addReturnValueInfo(return_value.first, pred);
           }
-          // is success block
         }
+        // Decode the call_inst by chaning
+      } else {
+        if (return_value->getValueID() > 0) {
+          func_info->addReturnValueInfo(FunctionInformation::kSuccessCode,
+                                        pred);
+          func_info->addReturnValueInfo(FunctionInformation::kErrorCode,
+                                        pred);
+        }
+        // is success block
       }
     }
   }
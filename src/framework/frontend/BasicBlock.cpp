@@ -103,6 +103,27 @@ bool BasicBlockInformation::changeValueState(
   return changed;
 }
 
+std::vector<std::shared_ptr<framework::Value>>
+BasicBlockInformation::changeValueStates(
+    TransitionTable& table,
+    const std::set<std::shared_ptr<framework::Value>>& values,
+    std::shared_ptr<framework::Instruction> instruction) {
+  std::vector<std::shared_ptr<framework::Value>> changed, block_values;
+  for (auto& value : values) {
+    if (!framework::shared_isa<Argument>(value)) {
+      block_values.push_back(value);
+      continue;
+    }
+    if (changeValueState(table.Transitions(), value, instruction))
+      changed.push_back(value);
+  }
+
+  auto changed_values =
+      value_states_.transitionStates(table, block_values, instruction);
+  changed.insert(changed.end(), changed_values.begin(), changed_values.end());
+  return changed;
+}
+
 bool BasicBlockInformation::valueHasState(std::shared_ptr<Value> value) {
   return value_states_.valueExists(value);
 }
@@ -168,17 +189,9 @@ BasicBlockInformation::ValueStatesForSuccessor(
     return states;
   }
 
-  std::shared_ptr<framework::CallInst> call_inst =
-      framework::shared_dyn_cast<framework::CallInst>(
-          basic_block_->getBranchInst()->Condition());
-
-  if (auto compare_inst = framework::shared_dyn_cast<framework::CompareInst>(
-          basic_block_->getBranchInst()->Condition())) {
-    auto operand = std::find_if(
-        compare_inst->Operands().begin(), compare_inst->Operands().end(),
-        [](auto operand) { return framework::shared_isa<CallInst>(operand); });
-    call_inst = framework::shared_dyn_cast<CallInst>(*operand);
-  }
+  auto& calls = basic_block_->getBranchInst()->Facts().calls;
+  if (calls.empty()) return states;
+  auto call_inst = calls.front();
 
   auto operands = call_inst->Arguments();
   for (int i = 0; i < operands.size(); i++) {
@@ -201,20 +214,15 @@ BasicBlockInformation::ReturnCodeForSuccessor(
     std::shared_ptr<framework::BasicBlock> successor) {
   std::set<std::shared_ptr<framework::Value>> return_values = return_values_;
   auto branch_inst = basic_block_->getBranchInst();
-  if (!branch_inst || !branch_inst->Condition()) return return_values;
-
-  auto compare_inst = framework::shared_dyn_cast<framework::CompareInst>(
-      branch_inst->Condition());
-  if (!compare_inst) return return_values;
+  if (!branch_inst || !branch_inst->Condition() ||
+      !framework::shared_isa<CompareInst>(branch_inst->Condition()))
+    return return_values;
   if (pending_values_.find(successor) != pending_values_.end()) {
     return_values.insert(pending_values_[successor].return_values.begin(),
                          pending_values_[successor].return_values.end());
 
-    auto operand = std::find_if(
-        compare_inst->Operands().begin(), compare_inst->Operands().end(),
-        [](auto operand) { return framework::shared_isa<CallInst>(operand); });
-
-    return_values.erase(*operand);
+    auto& calls = branch_inst->Facts().calls;
+    if (!calls.empty()) return_values.erase(calls.front());
   }
 
   /* for (auto return_value : return_values) { */
@@ -228,7 +236,7 @@ BasicBlockInformation::ReturnCodeForSuccessor(
 
 BasicBlockValueStates::BasicBlockValueStates(
     const BasicBlockValueStates& states)
-    : value_states_(states.value_states_) {}
+    : value_states_(states.value_states_), bug_values_(states.bug_values_) {}
 
 bool BasicBlockValueStates::operator==(const BasicBlockValueStates& states) {
   return value_states_ == states.value_states_;
@@ -242,12 +250,31 @@ bool BasicBlockValueStates::valueExists(
 void BasicBlockValueStates::setValueState(
     std::shared_ptr<framework::Value> value, framework::Transition& transition,
     std::shared_ptr<framework::Instruction> instruction) {
-  value_states_[value].addTransition(transition, instruction);
+  auto& logs = value_states_[value];
+  logs.addTransition(transition, instruction);
+  indexValue(value, logs);
 }
 
 void BasicBlockValueStates::setValueState(
     std::shared_ptr<framework::Value> value, framework::TransitionLogs& logs) {
-  value_states_[value] = logs;
+  indexValue(value, value_states_[value] = logs);
+}
+
+void BasicBlockValueStates::removeValues(
+    const std::function<bool(const std::shared_ptr<framework::Value>&,
+                             const TransitionLogs&)>& remove) {
+  for (auto value = value_states_.begin(); value != value_states_.end();) {
+    if (remove(value->first, value->second))
+      value = value_states_.erase(value);
+    else
+      value++;
+  }
+}
+
+void BasicBlockValueStates::indexValue(std::shared_ptr<framework::Value> value,
+                                       const framework::TransitionLogs& logs) {
+  if (!logs.isDummy() && logs.CurrentState().isBugState())
+    bug_values_[logs.CurrentState()].insert(value);
 }
 
 TransitionLogs& BasicBlockValueStates::getTransitionLog(
@@ -269,6 +296,21 @@ std::vector<std::pair<std::shared_ptr<framework::Value>, TransitionLogs*>>
 BasicBlockValueStates::getValueTransitionStates(const framework::State& state) {
   std::vector<std::pair<std::shared_ptr<framework::Value>, TransitionLogs*>>
       values;
+  if (state.isBugState()) {
+    auto& bucket = bug_values_[state];
+    for (auto value = bucket.begin(); value != bucket.end();) {
+      auto logs = value_states_.find(*value);
+      if (logs == value_states_.end() || logs->second.isDummy() ||
+          logs->second.CurrentState() != state) {
+        value = bucket.erase(value);
+        continue;
+      }
+      values.push_back(std::make_pair(*value, &logs->second));
+      value++;
+    }
+    return values;
+  }
+
   for (auto value = value_states_.begin(); value != value_states_.end();
        value++) {
     if (value->second.CurrentState() == state)
@@ -323,6 +365,49 @@ bool BasicBlockValueStates::transitionState(
   return false;
 }
 
+std::vector<std::shared_ptr<framework::Value>>
+BasicBlockValueStates::transitionStates(
+    const TransitionTable& table,
+    const std::vector<std::shared_ptr<framework::Value>>& values,
+    std::shared_ptr<framework::Instruction> instruction) {
+  std::vector<std::shared_ptr<framework::Value>> changed, tracked;
+  std::vector<TransitionLogs*> logs;
+  std::vector<uint8_t> column;
+
+  // Gather the states of the tracked values, in the same order as
+  // transitionState would visit them
+  for (auto& value : values) {
+    auto states = value_states_.find(value);
+    if (states == value_states_.end()) {
+      if (!table.InitTransition()) continue;
+      Transition transition = *table.InitTransition();
+      setValueState(value, transition, instruction);
+      changed.push_back(value);
+      continue;
+    }
+
+    const TransitionLogs& current_transitions = states->second;
+    if (current_transitions.CurrentInstruction() == instruction ||
+        !(*current_transitions.CurrentInstruction() <= *instruction))
+      continue;
+    tracked.push_back(value);
+    logs.push_back(&states->second);
+    column.push_back(table.Index(current_transitions.CurrentState()));
+  }
+
+  std::vector<uint8_t> sources(column);
+  table.apply(column.data(), column.size());
+
+  for (size_t i = 0; i < column.size(); i++) {
+    if (column[i] == TransitionTable::kNone) continue;
+    Transition transition = *table.TransitionFrom(sources[i]);
+    logs[i]->addTransition(transition, instruction);
+    indexValue(tracked[i], *logs[i]);
+    changed.push_back(tracked[i]);
+  }
+  return changed;
+}
+
 void BasicBlockValueStates::print() {
   for (auto states : value_states_) {
     llvm::errs() << states.first << " " << states.second.ReducedTransition()
@@ -393,16 +478,28 @@ ArgValueStates::ArgValueStates(uint64_t arg_num, const std::set<State>& states)
     : value_states_(arg_num), states_(states) {}
 
 ArgValueStates::ArgValueStates(const ArgValueStates& arg_value_states)
-    : states_(arg_value_states.states_) {
+    : states_(arg_value_states.states_),
+      bug_values_(arg_value_states.bug_values_) {
   value_states_ = arg_value_states.value_states_;
 }
 
 ArgValueStates& ArgValueStates::operator=(
     const ArgValueStates& arg_value_states) {
   value_states_ = arg_value_states.value_states_;
+  bug_values_ = arg_value_states.bug_values_;
   return *this;
 }
 
+void ArgValueStates::indexValue(uint64_t arg,
+                                std::shared_ptr<framework::Value> value) {
+  for (auto& transition_logs : value_states_[arg][value].TransitionPerState()) {
+    auto& logs = transition_logs.second;
+    if (!logs.isDummy() && logs.LeastSignificantSource().isInitState() &&
+        logs.MostSignificantTarget().isBugState())
+      bug_values_[logs.MostSignificantTarget()].insert({arg, value});
+  }
+}
+
 const std::map<std::shared_ptr<framework::Value>, std::vector<Transition>>
 ArgValueStates::getValueStateForArg(int64_t index) const {
   std::map<std::shared_ptr<framework::Value>, std::vector<Transition>> new_map;
@@ -443,6 +540,26 @@ std::vector<std::pair<std::shared_ptr<framework::Value>, TransitionLogs*>>
 ArgValueStates::getValueTransitionStates(const framework::State& state) {
   std::vector<std::pair<std::shared_ptr<framework::Value>, TransitionLogs*>>
       values;
+  if (state.isBugState()) {
+    auto& bucket = bug_values_[state];
+    for (auto entry = bucket.begin(); entry != bucket.end();) {
+      auto found = value_states_[entry->first].find(entry->second);
+      bool matched = false;
+      if (found != value_states_[entry->first].end()) {
+        for (auto& transition_logs : found->second.TransitionPerState()) {
+          auto& logs = transition_logs.second;
+          if (logs.isDummy() || !logs.LeastSignificantSource().isInitState() ||
+              logs.MostSignificantTarget() != state)
+            continue;
+          values.push_back(std::make_pair(entry->second, &logs));
+          matched = true;
+        }
+      }
+      entry = matched ? std::next(entry) : bucket.erase(entry);
+    }
+    return values;
+  }
+
   for (auto& value_states : value_states_) {
     for (auto value = value_states.begin(); value != value_states.end();
          value++) {
@@ -489,6 +606,7 @@ void ArgValueStates::addArgValueState(const ArgValueStates& states) {
         value_states_[arg_idx][value].addArgTransitions(arg_transitions);
       else
         value_states_[arg_idx][value] = ArgTransitions(arg_transitions);
+      indexValue(arg_idx, value);
 
       /* for (auto trans: value_states_[arg_idx][value].TransitionPerState()) {
        */
@@ -539,8 +657,10 @@ bool ArgValueStates::transitionState(
     if (!ValueExistsInArg(arg_index, value))
       value_states_[arg_index][value] = ArgTransitions(states_);
 
-    return value_states_[arg_index][value].addTransition(transitions,
-                                                         instruction);
+    bool changed =
+        value_states_[arg_index][value].addTransition(transitions, instruction);
+    if (changed) indexValue(arg_index, value);
+    return changed;
 
     /* std::set<int> updated_logs; */
     /* std::vector<TransitionLogs> new_logs; */
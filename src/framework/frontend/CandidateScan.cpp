@@ -0,0 +1,96 @@
+#include "frontend/CandidateScan.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <deque>
+#include <set>
+
+#include "core/Casting.hpp"
+#include "core/Instructions.hpp"
+
+namespace framework {
+CandidateScan::CandidateScan(framework::StateManager& state_manager)
+    : transition_manager_(state_manager.TransitionManager()),
+      required_calls_(requiredCalls(state_manager)) {}
+
+// 0-1 BFS over the state machine, where only the transitions triggered by a
+// call have a cost
+unsigned CandidateScan::requiredCalls(framework::StateManager& state_manager) {
+  std::map<State, std::vector<std::pair<State, unsigned>>> edges;
+  for (auto& transition : transition_manager_->getValueTransitions())
+    edges[transition.Source()].push_back({transition.Target(), 0});
+  for (auto& transition : transition_manager_->getCallTransitions())
+    edges[transition.Source()].push_back({transition.Target(), 1});
+
+  // Copies of the manager do not keep their init state pointer valid, so
+  // look it up among the states
+  std::map<State, unsigned> distance;
+  std::deque<State> queue;
+  for (auto& state : state_manager.getStates()) {
+    if (!state.isInitState()) continue;
+    distance[state] = 0;
+    queue.push_back(state);
+  }
+  while (!queue.empty()) {
+    State state = queue.front();
+    queue.pop_front();
+    if (state.isBugState()) return distance[state];
+
+    for (auto& edge : edges[state]) {
+      unsigned cost = distance[state] + edge.second;
+      auto known = distance.find(edge.first);
+      if (known != distance.end() && known->second <= cost) continue;
+
+      distance[edge.first] = cost;
+      if (edge.second)
+        queue.push_back(edge.first);
+      else
+        queue.push_front(edge.first);
+    }
+  }
+  return UINT_MAX;
+}
+
+unsigned CandidateScan::countCalls(
+    std::shared_ptr<framework::Function> function) {
+  auto known = calls_.find(function);
+  if (known != calls_.end()) return known->second;
+
+  // Recursive calls may repeat any transition
+  calls_[function] = required_calls_;
+
+  unsigned calls = 0;
+  for (auto& block : function->BasicBlocks()) {
+    // The blocks of a loop are analyzed again until the states settle
+    unsigned repeat = function->hasLoopInfo()
+                          ? (function->isLoopBlock(block) ? 2 : 1)
+                          : (function->ContainsLoopBackBlock() ? 2 : 1);
+
+    for (auto& inst : block->Instructions()) {
+      auto call_inst = shared_dyn_cast<framework::CallInst>(inst);
+      if (!call_inst) continue;
+
+      auto callee = call_inst->CalledFunction();
+      unsigned callee_calls = 0;
+      if (!callee || callee->isDebugFunction())
+        continue;
+      else if (transition_manager_->isTransitionFunction(callee->Name()))
+        callee_calls = 1;
+      else if (!callee->isDeclaration())
+        callee_calls = countCalls(callee);
+
+      calls = std::min<uint64_t>(
+          required_calls_, calls + static_cast<uint64_t>(callee_calls) * repeat);
+    }
+    if (calls >= required_calls_) break;
+  }
+
+  calls_[function] = calls;
+  return calls;
+}
+
+bool CandidateScan::isCandidate(std::shared_ptr<framework::Function> function) {
+  if (required_calls_ == UINT_MAX) return false;
+  return countCalls(function) >= required_calls_;
+}
+}  // namespace framework
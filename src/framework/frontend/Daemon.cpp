@@ -0,0 +1,136 @@
+#include "frontend/Daemon.hpp"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace framework {
+namespace daemon {
+bool writeAll(int fd, const void* data, size_t size) {
+  auto buffer = static_cast<const char*>(data);
+  while (size > 0) {
+    ssize_t written = write(fd, buffer, size);
+    if (written < 0 && errno == EINTR) continue;
+    if (written <= 0) return false;
+    buffer += written;
+    size -= written;
+  }
+  return true;
+}
+
+bool readAll(int fd, void* data, size_t size) {
+  auto buffer = static_cast<char*>(data);
+  while (size > 0) {
+    ssize_t size_read = read(fd, buffer, size);
+    if (size_read < 0 && errno == EINTR) continue;
+    if (size_read <= 0) return false;
+    buffer += size_read;
+    size -= size_read;
+  }
+  return true;
+}
+
+static bool fillAddress(const std::string& path, struct sockaddr_un& address) {
+  if (path.size() >= sizeof(address.sun_path)) return false;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+  return true;
+}
+
+int connectSocket(const std::string& path) {
+  struct sockaddr_un address;
+  if (!fillAddress(path, address)) return -1;
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) return -1;
+
+  if (connect(fd, reinterpret_cast<struct sockaddr*>(&address),
+              sizeof(address)) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+int listenSocket(const std::string& path) {
+  struct sockaddr_un address;
+  if (!fillAddress(path, address)) return -1;
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) return -1;
+
+  unlink(path.c_str());
+  if (bind(fd, reinterpret_cast<struct sockaddr*>(&address),
+           sizeof(address)) < 0 ||
+      listen(fd, SOMAXCONN) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+std::string detectorKey(framework::StateManager& manager) {
+  std::vector<std::string> names;
+  for (auto& state : manager.getBugStates()) names.push_back(state.Name());
+  std::sort(names.begin(), names.end());
+
+  std::string key;
+  for (auto& name : names) key += (key.empty() ? "" : ",") + name;
+  return key;
+}
+
+DaemonClient::DaemonClient(const std::string& socket_path)
+    : fd_(connectSocket(socket_path)) {}
+
+DaemonClient::~DaemonClient() {
+  if (connected()) close(fd_);
+}
+
+bool DaemonClient::sendModule(llvm::Module& M, llvm::StringRef snapshot,
+                              bool wait_reply,
+                              const std::vector<std::string>& detectors) {
+  if (!connected()) return false;
+
+  std::string detector_list;
+  for (auto& detector : detectors) detector_list += detector + "\n";
+
+  const std::string& name = M.getModuleIdentifier();
+  RequestHeader header{kMagic, kProtocolVersion,
+                       wait_reply ? RequestFlags::NONE : RequestFlags::NO_REPLY,
+                       static_cast<uint32_t>(name.size()),
+                       static_cast<uint32_t>(detector_list.size()),
+                       static_cast<uint64_t>(snapshot.size())};
+
+  ReplyStatus status;
+  return writeAll(fd_, &header, sizeof(header)) &&
+         writeAll(fd_, name.data(), name.size()) &&
+         writeAll(fd_, detector_list.data(), detector_list.size()) &&
+         writeAll(fd_, snapshot.data(), snapshot.size()) &&
+         readAll(fd_, &status, sizeof(status)) && status == ACCEPTED;
+}
+
+void DaemonClient::relayReports(llvm::raw_ostream& stream) {
+  if (!connected()) return;
+
+  char buffer[4096];
+  ssize_t size = 0;
+  while ((size = read(fd_, buffer, sizeof(buffer))) != 0) {
+    if (size < 0 && errno == EINTR) continue;
+    if (size < 0) break;
+    stream.write(buffer, size);
+  }
+  stream.flush();
+}
+}  // namespace daemon
+}  // namespace framework
@@ -5,6 +5,7 @@
 #include "llvm/IR/CFG.h"
 #include "llvm/IR/Constant.h"
 #include "llvm/IR/DataLayout.h"
+#include "llvm/IR/DebugInfo.h"
 #include "llvm/IR/DebugInfoMetadata.h"
 #include "llvm/IR/DebugLoc.h"
 #include "llvm/IR/DerivedTypes.h"
@@ -42,12 +43,18 @@
 
 #include "Analyzer.hpp"
 #include "BasicBlock.hpp"
+#include "Daemon.hpp"
 #include "Framework.hpp"
 #include "Function.hpp"
 #include "IRGenerator.hpp"
+#include "Jobserver.hpp"
 #include "Logs.hpp"
+#include "MemoryGovernor.hpp"
+#include "MultiAutomaton.hpp"
+#include "SFG/Converter.hpp"
 #include "State.hpp"
 #include "StateTransition.hpp"
+#include "Supervisor.hpp"
 #include "Utils.hpp"
 #include "Value.hpp"
 #include "ValueTypeAlias.hpp"
@@ -59,7 +66,120 @@ static llvm::cl::opt<bool> Async(
 static llvm::cl::opt<bool> MeasureTime("measure",
                                        llvm::cl::desc("Measure analysis time"));
 
+static llvm::cl::opt<std::string> DaemonSocket(
+    "fitxd-socket",
+    llvm::cl::desc("Hand the module over to the fitxd daemon listening on "
+                   "the given unix socket instead of analyzing it in-process"));
+
+static llvm::cl::opt<bool> AnalysisOnly(
+    "fitx-analysis-only",
+    llvm::cl::desc("Analyze the module before the optimizations and leave "
+                   "only stub function bodies for the rest of the pipeline"));
+
+static llvm::cl::opt<unsigned> MemoryBudget(
+    "fitx-memory-budget",
+    llvm::cl::desc("Memory in MB shared by the analyzers of all the "
+                   "concurrent compiles (0: unlimited)"),
+    llvm::cl::init(0));
+
+static llvm::cl::opt<unsigned> MemoryWait(
+    "fitx-memory-wait",
+    llvm::cl::desc("Seconds to wait for the memory budget before running "
+                   "the detectors one after the other"),
+    llvm::cl::init(60));
+
+static llvm::cl::opt<unsigned> WorkerTimeout(
+    "fitx-worker-timeout",
+    llvm::cl::desc("Kill an analyzer running longer than the given seconds "
+                   "(0: no limit)"),
+    llvm::cl::init(0));
+
+static llvm::cl::opt<unsigned> WorkerStallTimeout(
+    "fitx-worker-stall-timeout",
+    llvm::cl::desc("Kill an analyzer making no progress for longer than "
+                   "the given seconds (0: no limit)"),
+    llvm::cl::init(0));
+
+static llvm::cl::opt<unsigned> WorkerCPULimit(
+    "fitx-worker-cpu-limit",
+    llvm::cl::desc("CPU seconds an analyzer may use (0: no limit)"),
+    llvm::cl::init(0));
+
+static llvm::cl::opt<unsigned> WorkerMemoryLimit(
+    "fitx-worker-memory-limit",
+    llvm::cl::desc("Memory in MB an analyzer may allocate on top of the "
+                   "compiler (0: no limit)"),
+    llvm::cl::init(0));
+
+static llvm::cl::opt<bool> MultiAutomatonFilter(
+    "fitx-multi-automaton",
+    llvm::cl::desc("Run the state machines of all the detectors at once "
+                   "first, and only analyze the detectors and the functions "
+                   "that may reach a bug state"),
+    llvm::cl::init(true));
+
 namespace framework {
+// The functions each detector may reach a bug state from. Empty when the
+// prefilter is off, i.e. every function is a candidate.
+using Candidates = std::vector<std::set<Function *>>;
+
+static Candidates findCandidates(llvm::Module &M,
+                                 std::vector<StateManager> &managers) {
+  auto &context = AnalysisContext::Current();
+  if (!MultiAutomatonFilter || !context.hasFrameworkIR(&M)) return {};
+
+  Candidates candidates(managers.size());
+  MultiAutomaton automaton(managers);
+  for (auto function : context.FrameworkIR(&M)) {
+    MultiAutomaton::Word detectors = automaton.Candidates(function);
+    for (size_t k = 0; k < managers.size(); k++) {
+      if (k >= MultiAutomaton::kMaxDetectors || (detectors >> k & 1))
+        candidates[k].insert(function.get());
+    }
+  }
+  return candidates;
+}
+
+static bool hasCandidates(const Candidates &candidates, size_t detector) {
+  return candidates.empty() || !candidates[detector].empty();
+}
+
+static void filterCandidates(Analyzer &analyzer, const Candidates &candidates,
+                             size_t detector) {
+  if (candidates.empty()) return;
+  auto &functions = candidates[detector];
+  analyzer.setCandidateFilter([&functions](std::shared_ptr<Function> function) {
+    return functions.count(function.get()) > 0;
+  });
+}
+
+// Replace every function body with an unreachable stub. The optimizations
+// and the code generation then have almost nothing left to do, while the
+// object still defines the same symbols for the build to link.
+static bool stubOutModule(llvm::Module &M) {
+  AnalysisContext::Current().releaseFrameworkIR(&M);
+
+  for (auto &function : M) {
+    if (function.isDeclaration()) continue;
+    function.dropAllReferences();
+    function.getBasicBlockList().clear();
+
+    auto stub = llvm::BasicBlock::Create(M.getContext(), "stub", &function);
+    new llvm::UnreachableInst(M.getContext(), stub);
+  }
+  llvm::StripDebugInfo(M);
+  return true;
+}
+
+// Size of the analysis, used to estimate its memory usage
+static uint64_t analysisUnits(llvm::Module &M) {
+  uint64_t units = Converter::GetInstance().Size();
+  for (auto &function : ir_generator::IRGenerator::FrameworkIR(M)) {
+    for (auto &block : function->OrderedBasicBlocks())
+      units += block->Instructions().size();
+  }
+  return units;
+}
 
 struct AnalyzerInfo {
   Analyzer *inner_analyzer;
@@ -67,17 +187,141 @@ struct AnalyzerInfo {
 
   AnalyzerInfo(Analyzer *analyzer) : inner_analyzer(analyzer) {}
 
-  void start_analyzer_process() {
+  // False if the process could not be forked. The job slot is held for as
+  // long as the process runs and handed back by the parent once it reaps
+  // the process, whatever way it ended.
+  bool start_analyzer_process(Jobserver &jobserver, MemoryGovernor &governor,
+                              int reservation, uint64_t units) {
     process_id = fork();
     if (process_id == 0) {
+      governor.adopt(reservation);
+      MemoryGovernor::Growth growth;
       run_analyzer();
+      governor.release(reservation, units, growth.Peak());
+
+      // Asynchronous analyzers are never reaped
+      if (Async) jobserver.release();
       exit(0);
     }
+    return process_id > 0;
   }
 
   void run_analyzer() { inner_analyzer->analyze(); }
 };
 
+// Run every analyzer in a supervised worker. The compiler's own job slot
+// runs one worker, the jobserver tokens and the memory budget allow more.
+static void superviseAnalyzers(llvm::Module &M,
+                               std::vector<StateManager> &managers,
+                               const Candidates &candidates,
+                               const Supervisor::Limits &limits) {
+  MemoryGovernor governor(static_cast<uint64_t>(MemoryBudget) << 20);
+  uint64_t units = analysisUnits(M);
+  uint64_t estimate = governor.estimate(units);
+  int reservation =
+      governor.reserve(estimate, std::chrono::seconds(MemoryWait));
+  bool sequential =
+      governor.active() && reservation == MemoryGovernor::kNoReservation;
+  uint64_t used_bytes = 0;
+
+  // The implicit slot runs on the reservation of the compiler
+  struct Slot {
+    bool implicit;
+    bool token;
+    int reservation;
+  };
+  std::map<int, Slot> slots;
+  bool implicit_slot_free = true;
+
+  auto run_analyzer = [&](size_t detector, LoggingClient &client,
+                          Analyzer::ProgressCallback progress) {
+    Analyzer analyzer(M, managers[detector], client);
+    filterCandidates(analyzer, candidates, detector);
+    analyzer.setMemoryBudget(static_cast<uint64_t>(MemoryBudget) << 20);
+    analyzer.setProgressCallback(progress);
+    analyzer.analyze();
+  };
+
+  Jobserver jobserver;
+  Supervisor supervisor(M.getModuleIdentifier(), limits);
+  size_t next = 0;
+  while (next < managers.size() || supervisor.Running()) {
+    while (next < managers.size()) {
+      if (!hasCandidates(candidates, next)) {
+        next++;
+        continue;
+      }
+
+      Slot slot = {implicit_slot_free, false, MemoryGovernor::kNoReservation};
+      if (!slot.implicit) {
+        if (sequential || (jobserver.active() && !jobserver.acquire())) break;
+        slot.token = jobserver.active();
+        slot.reservation =
+            governor.reserve(estimate, std::chrono::milliseconds(0));
+        if (governor.active() &&
+            slot.reservation == MemoryGovernor::kNoReservation) {
+          if (slot.token) jobserver.release();
+          break;
+        }
+      }
+
+      int worker = supervisor.spawn(
+          "analyzer" + std::to_string(next),
+          [&](LoggingClient &client, Supervisor::Heartbeat heartbeat) {
+            run_analyzer(next, client,
+                         [&](std::shared_ptr<Function> function) {
+                           heartbeat(function->Name());
+                         });
+          });
+      if (worker < 0) {
+        if (slot.token) jobserver.release();
+        governor.release(slot.reservation, 0, 0);
+        if (!slot.implicit) break;
+
+        // Unsupervised on the implicit slot rather than skipped
+        std::string log;
+        {
+          LoggingClient client(log);
+          run_analyzer(next, client, nullptr);
+          client.flush();
+        }
+        llvm::errs() << log;
+        next++;
+        continue;
+      }
+
+      if (slot.implicit) implicit_slot_free = false;
+      slots[worker] = slot;
+      next++;
+    }
+
+    Supervisor::Worker finished;
+    if (!supervisor.waitAny(llvm::errs(), finished)) break;
+
+    uint64_t growth =
+        finished.max_resident_size > finished.initial_resident_size
+            ? finished.max_resident_size - finished.initial_resident_size
+            : 0;
+    Slot slot = slots[finished.id];
+    slots.erase(finished.id);
+    if (slot.token) jobserver.release();
+    if (slot.implicit) {
+      implicit_slot_free = true;
+      used_bytes = std::max(used_bytes, growth);
+    } else {
+      governor.release(slot.reservation, units, growth);
+    }
+  }
+  governor.release(reservation, units, used_bytes);
+
+  for (; next < managers.size(); next++) {
+    if (!hasCandidates(candidates, next)) continue;
+    llvm::errs() << "[ABORTED] module=" << M.getModuleIdentifier()
+                 << " analyzer=analyzer" << next
+                 << " function=- reason=not started\n";
+  }
+}
+
 FrameworkPass::FrameworkPass() : ModulePass(ID) {}
 
 void FrameworkPass::getAnalysisUsage(llvm::AnalysisUsage &AU) const {
@@ -91,29 +335,137 @@ bool FrameworkPass::runOnModule(llvm::Module &M) {
   LoggingServer server;
 
   start = std::chrono::system_clock::now();
+
+  // Only the last detector may stub the module out
+  bool stub_module =
+      AnalysisOnly && (passes.empty() || passes.back() == this);
+
   defineStates();
 
+  // Falls back to the in-process analysis if the daemon is not reachable or
+  // lacks one of the detectors, or if no snapshot was taken before the
+  // optimizations
+  if (!DaemonSocket.empty() && AnalysisContext::Current().hasSnapshot(&M)) {
+    const std::string &snapshot = AnalysisContext::Current().Snapshot(&M);
+    std::vector<std::string> detectors;
+    for (auto &manager : manager_)
+      detectors.push_back(daemon::detectorKey(manager));
+
+    daemon::DaemonClient client(DaemonSocket);
+    if (client.sendModule(M, snapshot, !Async, detectors)) {
+      if (!Async) client.relayReports(llvm::errs());
+      end = std::chrono::system_clock::now();
+      if (MeasureTime) {
+        llvm::errs() << "[Elapsed Calculated] (" << M.getName() << ") "
+                     << std::chrono::duration_cast<std::chrono::milliseconds>(
+                            end - start)
+                            .count()
+                     << "\n";
+      }
+      return stub_module && stubOutModule(M);
+    }
+  }
+
+  Candidates candidates = findCandidates(M, manager_);
+
+  Supervisor::Limits limits;
+  limits.cpu_seconds = WorkerCPULimit;
+  limits.address_space = static_cast<uint64_t>(WorkerMemoryLimit) << 20;
+  limits.timeout = WorkerTimeout;
+  limits.stall_timeout = WorkerStallTimeout;
+
+  if (limits.enabled()) {
+    if (!Async) {
+      superviseAnalyzers(M, manager_, candidates, limits);
+    } else if (pid_t supervisor = fork(); supervisor == 0) {
+      // Detach the supervisor so that the compiler does not leave zombies
+      if (fork() == 0) superviseAnalyzers(M, manager_, candidates, limits);
+      exit(0);
+    } else if (supervisor > 0) {
+      waitpid(supervisor, nullptr, 0);
+    }
+
+    end = std::chrono::system_clock::now();
+    if (MeasureTime) {
+      llvm::errs() << "[Elapsed Calculated] (" << M.getName() << ") "
+                   << std::chrono::duration_cast<std::chrono::milliseconds>(
+                          end - start)
+                          .count()
+                   << "\n";
+    }
+    return stub_module && stubOutModule(M);
+  }
+
   // Create analyzers and spawn threads
   std::vector<AnalyzerInfo> analyzers;
-  for (framework::StateManager &manager : manager_) {
+  for (size_t detector = 0; detector < manager_.size(); detector++) {
+    if (!hasCandidates(candidates, detector)) continue;
     LoggingClient *client = new LoggingClient();
-    AnalyzerInfo info =
-        AnalyzerInfo(new framework::Analyzer(M, manager, *client));
+    AnalyzerInfo info = AnalyzerInfo(
+        new framework::Analyzer(M, manager_[detector], *client));
+    info.inner_analyzer->setMemoryBudget(static_cast<uint64_t>(MemoryBudget)
+                                         << 20);
+    filterCandidates(*info.inner_analyzer, candidates, detector);
     analyzers.push_back(info);
     server.addClient(client);
   }
 
-  for (auto analyzer = analyzers.begin() + 1; analyzer != analyzers.end();
-       analyzer++) {
-    analyzer->start_analyzer_process();
+  // The analyzer running here waits for its memory. If the budget stays
+  // exhausted, it proceeds anyway but no other analyzer is forked.
+  MemoryGovernor governor(static_cast<uint64_t>(MemoryBudget) << 20);
+  uint64_t units = analysisUnits(M);
+  uint64_t estimate = governor.estimate(units);
+  int reservation =
+      governor.reserve(estimate, std::chrono::seconds(MemoryWait));
+  bool sequential =
+      governor.active() && reservation == MemoryGovernor::kNoReservation;
+  MemoryGovernor::Growth growth;
+
+  // Under a make jobserver, the extra analyzers only get their own process
+  // if a job slot (and their memory) is free, the others run here one after
+  // the other
+  Jobserver jobserver;
+  std::vector<pid_t> forked;
+  auto fork_analyzer = [&](AnalyzerInfo &analyzer) {
+    if (sequential || (jobserver.active() && !jobserver.acquire()))
+      return false;
+
+    int worker_reservation =
+        governor.reserve(estimate, std::chrono::milliseconds(0));
+    if (governor.active() &&
+        worker_reservation == MemoryGovernor::kNoReservation) {
+      jobserver.release();
+      return false;
+    }
+
+    if (!analyzer.start_analyzer_process(jobserver, governor,
+                                         worker_reservation, units)) {
+      jobserver.release();
+      governor.release(worker_reservation, 0, 0);
+      return false;
+    }
+    forked.push_back(analyzer.process_id);
+    return true;
+  };
+
+  std::vector<AnalyzerInfo *> pending;
+  for (size_t analyzer = 1; analyzer < analyzers.size(); analyzer++) {
+    if (!fork_analyzer(analyzers[analyzer]))
+      pending.push_back(&analyzers[analyzer]);
   }
 
   // Start the first process here
-  analyzers.begin()->run_analyzer();
+  if (!analyzers.empty()) analyzers.begin()->run_analyzer();
+
+  for (auto analyzer : pending) {
+    if (!fork_analyzer(*analyzer)) analyzer->run_analyzer();
+  }
+  governor.release(reservation, units, growth.Peak());
 
   // Wait until the processes are done
-  for (int i = 0; !Async && i < analyzers.size() - 1; i++) {
-    wait(nullptr);
+  for (size_t i = 0; !Async && i < forked.size(); i++) {
+    waitpid(forked[i], nullptr, 0);
+    jobserver.release();
   }
 
   end = std::chrono::system_clock::now();
@@ -127,7 +479,7 @@ bool FrameworkPass::runOnModule(llvm::Module &M) {
                  << "\n";
   }
 
-  return false;
+  return stub_module && stubOutModule(M);
 }
 }  // namespace framework
 
@@ -139,12 +491,30 @@ static llvm::RegisterPass<framework::FrameworkPass> X(
 
 static void registerFrameworkPass(const llvm::PassManagerBuilder &,
                                   llvm::legacy::PassManagerBase &PM) {
+  // The daemon is handed the module as the framework IR was generated from it
+  if (!DaemonSocket.empty()) ir_generator::IRGenerator::keepSnapshots();
   for (auto &analysis_pass : framework::FrameworkPass::passes)
     PM.add(analysis_pass);
 }
 
+// In analysis-only mode, analyze before the optimizations so that they run
+// over stubs only
+static void registerOptimizedFrameworkPass(const llvm::PassManagerBuilder &PMB,
+                                           llvm::legacy::PassManagerBase &PM) {
+  if (!AnalysisOnly) registerFrameworkPass(PMB, PM);
+}
+
+static void registerEarlyFrameworkPass(const llvm::PassManagerBuilder &PMB,
+                                       llvm::legacy::PassManagerBase &PM) {
+  if (AnalysisOnly) registerFrameworkPass(PMB, PM);
+}
+
 static llvm::RegisterStandardPasses RegisterMyPass(
-    llvm::PassManagerBuilder::EP_OptimizerLast, registerFrameworkPass);
+    llvm::PassManagerBuilder::EP_OptimizerLast, registerOptimizedFrameworkPass);
+
+static llvm::RegisterStandardPasses RegisterMyPass2(
+    llvm::PassManagerBuilder::EP_ModuleOptimizerEarly,
+    registerEarlyFrameworkPass);
 
 static llvm::RegisterStandardPasses RegisterMyPass1(
     llvm::PassManagerBuilder::EP_EnabledOnOptLevel0, registerFrameworkPass);
@@ -82,110 +82,105 @@ FunctionInformation::createBasicBlockInfo(
 
   if (basic_block->isCleanupBlock()) return current_block_info;
 
+  // The states come from the CFG predecessors, or through the blocks that
+  // do not change them from the state flow graph predecessors
+  std::vector<StateFlowGraph::Edge> edges;
+  if (state_flow_graph_) {
+    edges = state_flow_graph_->Predecessors(basic_block);
+  } else {
+    for (auto& preds : basic_block->Predecessors())
+      edges.push_back({preds, basic_block});
+  }
+
   bool return_value_assigned = !current_block_info->ReturnValues().empty();
-  for (auto pred_reference : basic_block->Predecessors()) {
-    if (auto preds = pred_reference.lock()) {
-      if (!basicBlockInfoExists(preds)) {
+  for (auto edge : edges) {
+    auto preds = edge.source;
+    auto successor = edge.successor;
+    if (!basicBlockInfoExists(preds)) {
+      current_block_info->setPartialStates(true);
+      continue;
+    }
+    auto passthrough_blocks =
+        std::vector<std::shared_ptr<framework::BasicBlock>>();
+
+    auto weak_blocks = preds->getPassthroughBlock(successor);
+    std::transform(weak_blocks.begin(), weak_blocks.end(),
+                   std::back_inserter(passthrough_blocks),
+                   [](const std::weak_ptr<framework::BasicBlock> block) {
+                     return block.lock();
+                   });
+    if (!passthrough_blocks.size()) passthrough_blocks.push_back(preds);
+
+    for (auto block : passthrough_blocks) {
+      if (!basicBlockInfoExists(block)) {
         current_block_info->setPartialStates(true);
         continue;
       }
-      auto passthrough_blocks =
-          std::vector<std::shared_ptr<framework::BasicBlock>>();
-
-      auto weak_blocks = preds->getPassthroughBlock(basic_block);
-      std::transform(weak_blocks.begin(), weak_blocks.end(),
-                     std::back_inserter(passthrough_blocks),
-                     [](const std::weak_ptr<framework::BasicBlock> block) {
-                       return block.lock();
-                     });
-      if (!passthrough_blocks.size()) passthrough_blocks.push_back(preds);
-
-      for (auto block : passthrough_blocks) {
-        if (!basicBlockInfoExists(block)) {
+
+      auto pred_block_info = basic_block_info_[block];
+      if (pred_block_info->PartialStates()) {
+        if (block->Line() < basic_block->Line())
           current_block_info->setPartialStates(true);
-          continue;
-        }
+        else if (pred_block_info->TimeToLive() > 0)
+          current_block_info->setPartialStates(true);
+        continue;
+      }
 
-        auto pred_block_info = basic_block_info_[block];
-        if (pred_block_info->PartialStates()) {
-          if (block->Line() < basic_block->Line())
-            current_block_info->setPartialStates(true);
-          else if (pred_block_info->TimeToLive() > 0)
-            current_block_info->setPartialStates(true);
+      // TODO: Fix this rough check of error code propagation
+      BasicBlockInformation::BlockStatus status =
+          pred_block_info->getBlockStatus();
+      const auto& branch_inst =
+          pred_block_info->BasicBlock()->getBranchInst();
+      if (branch_inst && branch_inst->Facts().error_path)
+        status = BasicBlockInformation::ERROR;
+      current_block_info->setBlockStatus(status);
+
+      auto pred_value_states =
+          pred_block_info->ValueStatesForSuccessor(successor);
+      for (auto val_states : pred_value_states.first.ValueStates()) {
+        auto& value = val_states.first;
+        if (!current_block_info->ValueStates().valueExists(value)) {
+          current_block_info->ValueStates().setValueState(
+              value, pred_value_states.first.getTransitionLog(value));
           continue;
         }
 
-        // TODO: Fix this rough check of error code propagation
-        BasicBlockInformation::BlockStatus status =
-            pred_block_info->getBlockStatus();
-        const auto& branch_inst =
-            pred_block_info->BasicBlock()->getBranchInst();
-        if (branch_inst && branch_inst->Condition() &&
-            branch_inst->returnValueOperandExists()) {
-          status = BasicBlockInformation::ERROR;
-          if (auto condition =
-                  shared_dyn_cast<CompareInst>(branch_inst->Condition())) {
-            switch (condition->GetPredicate()) {
-              case llvm::CmpInst::Predicate::ICMP_EQ:
-              case llvm::CmpInst::Predicate::ICMP_SGT:
-                status = BasicBlockInformation::SUCCESS;
-              case llvm::CmpInst::Predicate::ICMP_NE:
-              case llvm::CmpInst::Predicate::ICMP_SLT:
-                status = BasicBlockInformation::ERROR;
-              default:
-                break;
-            }
-          }
-        }
-        current_block_info->setBlockStatus(status);
-
-        auto pred_value_states =
-            pred_block_info->ValueStatesForSuccessor(basic_block);
-        for (auto val_states : pred_value_states.first.ValueStates()) {
-          auto& value = val_states.first;
-          if (!current_block_info->ValueStates().valueExists(value)) {
-            current_block_info->ValueStates().setValueState(
-                value, pred_value_states.first.getTransitionLog(value));
-            continue;
-          }
-
-          auto pred_state = pred_value_states.first.getState(value);
-          auto curr_state = current_block_info->ValueStates().getState(value);
-          if (pred_state < curr_state) {
-            current_block_info->ValueStates().setValueState(
-                value, pred_value_states.first.getTransitionLog(value));
-          }
-
-          /* if (curr_state < pred_state) { */
-          /*   current_block_info->ValueStates().setValueState( */
-          /*       value, pred_value_states.first.getTransitionLog(value)); */
-          /* } */
-        }
-
-        /* if (!basic_block->Instructions().empty()) */
-        /*   generateWarning(basic_block->Instructions().front().get(), */
-        /*                   "Target"); */
-        if (!return_value_assigned) {
-          current_block_info->addReturnValues(
-              pred_block_info->ReturnCodeForSuccessor(basic_block));
+        auto pred_state = pred_value_states.first.getState(value);
+        auto curr_state = current_block_info->ValueStates().getState(value);
+        if (pred_state < curr_state) {
+          current_block_info->ValueStates().setValueState(
+              value, pred_value_states.first.getTransitionLog(value));
         }
 
-        current_block_info->getArgValueStates().addArgValueState(
-            pred_value_states.second);
-
-        /* generateWarning(pred_block_info->BasicBlock().get() ,"---"); */
-        /* for (auto ret_val : current_block_info->ReturnValues()) { */
-        /*   if (auto cv = framework::shared_dyn_cast<ConstValue>(ret_val)) { */
-        /*     generateWarning(current_block_info->BasicBlock().get(),
-         * std::to_string(cv->getConstValue())); */
-        /*   } */
+        /* if (curr_state < pred_state) { */
+        /*   current_block_info->ValueStates().setValueState( */
+        /*       value, pred_value_states.first.getTransitionLog(value)); */
         /* } */
-        /* generateWarning("---"); */
+      }
 
-        // TODO: Experimental: Enable when in use
-        /* current_block_info->getAliasValues().addAlias( */
-        /*     pred_block_info->getAliasValues()); */
+      /* if (!basic_block->Instructions().empty()) */
+      /*   generateWarning(basic_block->Instructions().front().get(), */
+      /*                   "Target"); */
+      if (!return_value_assigned) {
+        current_block_info->addReturnValues(
+            pred_block_info->ReturnCodeForSuccessor(successor));
       }
+
+      current_block_info->getArgValueStates().addArgValueState(
+          pred_value_states.second);
+
+      /* generateWarning(pred_block_info->BasicBlock().get() ,"---"); */
+      /* for (auto ret_val : current_block_info->ReturnValues()) { */
+      /*   if (auto cv = framework::shared_dyn_cast<ConstValue>(ret_val)) { */
+      /*     generateWarning(current_block_info->BasicBlock().get(),
+       * std::to_string(cv->getConstValue())); */
+      /*   } */
+      /* } */
+      /* generateWarning("---"); */
+
+      // TODO: Experimental: Enable when in use
+      /* current_block_info->getAliasValues().addAlias( */
+      /*     pred_block_info->getAliasValues()); */
     }
   }
 
@@ -271,6 +266,39 @@ void FunctionInformation::addReturnValueInfo(int64_t value,
   return_info_[value].insert(block_info.begin(), block_info.end());
 }
 
+const ArgValueStates* FunctionInformation::getReturnArgValueStates(
+    std::shared_ptr<framework::BasicBlock> basic_block) {
+  if (!released_) {
+    auto block_info = getBasicBlockInformation(basic_block);
+    return block_info ? &block_info->getArgValueStates() : nullptr;
+  }
+
+  auto found = return_arg_states_.find(basic_block.get());
+  return found != return_arg_states_.end() ? &found->second : nullptr;
+}
+
+void FunctionInformation::releaseAnalysisState() {
+  if (released_) return;
+  for (auto& return_info : return_info_) {
+    for (auto& block_ref : return_info.second) {
+      auto block = block_ref.lock();
+      if (!block || return_arg_states_.count(block.get())) continue;
+      if (auto block_info = getBasicBlockInformation(block))
+        return_arg_states_.emplace(block.get(),
+                                   block_info->getArgValueStates());
+    }
+  }
+  released_ = true;
+
+  basic_block_info_.clear();
+  prev_basic_block_info_.clear();
+  state_flow_graph_.reset();
+  value_liveness_.reset();
+  current_basicblock_.reset();
+  return_block_.reset();
+  alias_info_ = AliasValues();
+}
+
 bool FunctionInformation::existsInRefcountFunctions(
     std::shared_ptr<framework::Function> function) {
   return std::find(called_refcount_functions_.begin(),
@@ -0,0 +1,87 @@
+#include "frontend/Jobserver.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+namespace framework {
+Jobserver::Jobserver() {
+  const char* make_flags = getenv("MAKEFLAGS");
+  if (!make_flags) return;
+
+  // The last option wins, as for make itself
+  std::string auth;
+  std::istringstream flags(make_flags);
+  for (std::string flag; flags >> flag;) {
+    for (auto prefix : {"--jobserver-auth=", "--jobserver-fds="}) {
+      if (flag.rfind(prefix, 0) == 0) auth = flag.substr(strlen(prefix));
+    }
+  }
+  if (auth.empty()) return;
+
+  if (auth.rfind("fifo:", 0) == 0 ? !openFifo(auth.substr(5))
+                                  : !openPipe(auth)) {
+    if (read_fd_ >= 0) close(read_fd_);
+    read_fd_ = -1;
+  }
+}
+
+Jobserver::~Jobserver() {
+  if (read_fd_ >= 0) close(read_fd_);
+  if (owns_write_fd_ && write_fd_ >= 0) close(write_fd_);
+}
+
+bool Jobserver::openPipe(const std::string& auth) {
+  int read_fd = -1, write_fd = -1;
+  if (sscanf(auth.c_str(), "%d,%d", &read_fd, &write_fd) != 2) return false;
+
+  // make only passes the descriptors to the commands it knows to be
+  // recursive makes, otherwise they are closed or belong to something else
+  if (read_fd < 0 || write_fd < 0 || fcntl(read_fd, F_GETFD) < 0 ||
+      fcntl(write_fd, F_GETFD) < 0)
+    return false;
+
+  // Reopen the read end to get a non-blocking file description of our own,
+  // instead of changing the flags of the one shared with make
+  std::string path = "/proc/self/fd/" + std::to_string(read_fd);
+  read_fd_ = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+  write_fd_ = write_fd;
+  return read_fd_ >= 0;
+}
+
+bool Jobserver::openFifo(const std::string& path) {
+  read_fd_ = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+  write_fd_ = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+  owns_write_fd_ = true;
+  return read_fd_ >= 0 && write_fd_ >= 0;
+}
+
+bool Jobserver::acquire() {
+  if (!active()) return false;
+
+  char token;
+  ssize_t size = 0;
+  do {
+    size = read(read_fd_, &token, 1);
+  } while (size < 0 && errno == EINTR);
+  if (size != 1) return false;
+
+  tokens_.push_back(token);
+  return true;
+}
+
+void Jobserver::release() {
+  if (!active() || tokens_.empty()) return;
+
+  char token = tokens_.back();
+  tokens_.pop_back();
+  while (write(write_fd_, &token, 1) < 0 && errno == EINTR) {
+  }
+}
+}  // namespace framework
@@ -0,0 +1,279 @@
+#include "frontend/MemoryGovernor.hpp"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <iterator>
+#include <string>
+#include <thread>
+
+namespace framework {
+static constexpr uint32_t kGovernorMagic = 0x4f475846;  // "FXGO"
+static constexpr uint32_t kGovernorVersion = 2;
+// Initial guess, refined by the finished analyzers
+static constexpr uint64_t kInitialBytesPerUnit = 16 * 1024;
+static constexpr auto kPollInterval = std::chrono::milliseconds(100);
+
+static std::string segmentName() {
+  return "/fitx-governor-" + std::to_string(getuid());
+}
+
+MemoryGovernor::MemoryGovernor(uint64_t budget_bytes)
+    : budget_(budget_bytes) {
+  // A segment unlinked since it was opened is left for a new one
+  for (int i = 0; budget_ && !state_ && i < 3; i++) attach();
+}
+
+MemoryGovernor::~MemoryGovernor() { detach(); }
+
+bool MemoryGovernor::attach() {
+  std::string name = segmentName();
+  bool created = true;
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd < 0 && errno == EEXIST) {
+    created = false;
+    fd = shm_open(name.c_str(), O_RDWR, 0600);
+  }
+  if (fd < 0) return false;
+
+  if (created && ftruncate(fd, sizeof(State)) < 0) {
+    close(fd);
+    shm_unlink(name.c_str());
+    return false;
+  }
+
+  // The creator may still be sizing the segment
+  struct stat status;
+  for (int i = 0; !created && i < 50; i++) {
+    if (fstat(fd, &status) == 0 &&
+        static_cast<size_t>(status.st_size) >= sizeof(State))
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  void* memory = mmap(nullptr, sizeof(State), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) return false;
+  auto state = static_cast<State*>(memory);
+
+  if (created) {
+    pthread_mutexattr_t mutex_attr;
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&mutex_attr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&state->mutex, &mutex_attr);
+    pthread_mutexattr_destroy(&mutex_attr);
+
+    pthread_condattr_t cond_attr;
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&state->released, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+
+    state->reserved = 0;
+    state->bytes_per_unit = kInitialBytesPerUnit;
+    state->unlinked = false;
+    state->version = kGovernorVersion;
+    __atomic_store_n(&state->magic, kGovernorMagic, __ATOMIC_RELEASE);
+  }
+
+  for (int i = 0; i < 50; i++) {
+    if (__atomic_load_n(&state->magic, __ATOMIC_ACQUIRE) == kGovernorMagic)
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  if (state->magic != kGovernorMagic || state->version != kGovernorVersion) {
+    munmap(memory, sizeof(State));
+    return false;
+  }
+  state_ = state;
+
+  if (!lock()) {
+    detach();
+    return false;
+  }
+  bool unlinked = state_->unlinked;
+  // The budget of the latest compile applies to every one
+  if (!unlinked) state_->budget = budget_;
+  unlock();
+
+  if (unlinked) detach();
+  return !unlinked;
+}
+
+void MemoryGovernor::detach() {
+  if (state_) munmap(state_, sizeof(State));
+  state_ = nullptr;
+}
+
+bool MemoryGovernor::lock() {
+  int result = pthread_mutex_lock(&state_->mutex);
+  // The previous owner died while holding the lock. Its reservations are
+  // reclaimed like those of any dead process.
+  if (result == EOWNERDEAD) {
+    pthread_mutex_consistent(&state_->mutex);
+    result = 0;
+  }
+  return result == 0;
+}
+
+void MemoryGovernor::unlock() { pthread_mutex_unlock(&state_->mutex); }
+
+void MemoryGovernor::reclaimDeadReservations() {
+  for (auto& reservation : state_->reservations) {
+    if (!reservation.pid) continue;
+    if (kill(reservation.pid, 0) == 0 || errno != ESRCH) continue;
+
+    state_->reserved -= std::min(state_->reserved, reservation.bytes);
+    reservation = Reservation{0, 0};
+  }
+}
+
+int MemoryGovernor::tryReserve(uint64_t bytes) {
+  // A single analyzer larger than the budget may still run on its own
+  if (state_->reserved && state_->reserved + bytes > state_->budget)
+    return kNoReservation;
+
+  for (int i = 0; i < kMaxReservations; i++) {
+    if (state_->reservations[i].pid) continue;
+    state_->reservations[i] = Reservation{getpid(), bytes};
+    state_->reserved += bytes;
+    return i;
+  }
+  return kNoReservation;
+}
+
+uint64_t MemoryGovernor::estimate(uint64_t units) {
+  if (!active()) return 0;
+  return units * __atomic_load_n(&state_->bytes_per_unit, __ATOMIC_RELAXED);
+}
+
+int MemoryGovernor::reserve(uint64_t bytes,
+                            std::chrono::milliseconds timeout) {
+  if (!active() || !lock()) return kNoReservation;
+
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  int reservation = kNoReservation;
+  while (true) {
+    // Every reservation was released and the segment unlinked, so none of
+    // ours refers to it anymore
+    if (state_->unlinked) {
+      unlock();
+      detach();
+      if (!attach() || !lock()) return kNoReservation;
+      continue;
+    }
+
+    reclaimDeadReservations();
+    reservation = tryReserve(bytes);
+    if (reservation != kNoReservation) break;
+
+    auto now = std::chrono::steady_clock::now();
+    if (now >= deadline) break;
+
+    // Wake up regularly to reclaim the reservations of killed processes
+    struct timespec wake_up;
+    clock_gettime(CLOCK_MONOTONIC, &wake_up);
+    auto wait = std::min<std::chrono::nanoseconds>(deadline - now,
+                                                    kPollInterval);
+    wake_up.tv_nsec += wait.count();
+    wake_up.tv_sec += wake_up.tv_nsec / 1000000000;
+    wake_up.tv_nsec %= 1000000000;
+    if (pthread_cond_timedwait(&state_->released, &state_->mutex,
+                               &wake_up) == EOWNERDEAD)
+      pthread_mutex_consistent(&state_->mutex);
+  }
+
+  unlock();
+  return reservation;
+}
+
+void MemoryGovernor::adopt(int reservation) {
+  if (!active() || reservation == kNoReservation || !lock()) return;
+  state_->reservations[reservation].pid = getpid();
+  unlock();
+}
+
+void MemoryGovernor::release(int reservation, uint64_t units,
+                             uint64_t used_bytes) {
+  if (!active() || reservation == kNoReservation || !lock()) return;
+
+  auto& slot = state_->reservations[reservation];
+  if (slot.pid == getpid()) {
+    state_->reserved -= std::min(state_->reserved, slot.bytes);
+    slot = Reservation{0, 0};
+  }
+
+  // Moving average of the observed usage, so that estimates follow the
+  // modules being built
+  if (units && used_bytes) {
+    uint64_t observed = std::max<uint64_t>(1, used_bytes / units);
+    state_->bytes_per_unit = (state_->bytes_per_unit * 7 + observed) / 8;
+  }
+
+  // The last reservation is gone, so is the segment. Processes still mapping
+  // it move on to a new one when they reserve again.
+  bool unused = std::none_of(
+      std::begin(state_->reservations), std::end(state_->reservations),
+      [](const Reservation& reservation) { return reservation.pid; });
+  if (unused && !state_->unlinked) {
+    state_->unlinked = true;
+    shm_unlink(segmentName().c_str());
+  }
+
+  pthread_cond_broadcast(&state_->released);
+  unlock();
+}
+
+uint64_t MemoryGovernor::residentSize() {
+  long pages = 0, resident = 0;
+  FILE* statm = fopen("/proc/self/statm", "r");
+  if (!statm) return 0;
+  if (fscanf(statm, "%ld %ld", &pages, &resident) != 2) resident = 0;
+  fclose(statm);
+  return resident * sysconf(_SC_PAGESIZE);
+}
+
+bool MemoryGovernor::resetPeakResidentSize() {
+  int fd = open("/proc/self/clear_refs", O_WRONLY);
+  if (fd < 0) return false;
+  bool reset = write(fd, "5", 1) == 1;
+  close(fd);
+  return reset;
+}
+
+uint64_t MemoryGovernor::peakResidentSize() {
+  FILE* status = fopen("/proc/self/status", "r");
+  if (!status) return 0;
+  char line[256];
+  unsigned long long kilobytes = 0;
+  while (fgets(line, sizeof(line), status)) {
+    if (sscanf(line, "VmHWM: %llu kB", &kilobytes) == 1) break;
+  }
+  fclose(status);
+  return kilobytes * 1024;
+}
+
+MemoryGovernor::Growth::Growth()
+    : initial_resident_size_(residentSize()),
+      peak_reset_(resetPeakResidentSize()) {}
+
+uint64_t MemoryGovernor::Growth::Peak() const {
+  // Without a peak of its own, the current size is a lower bound
+  uint64_t resident_size = peak_reset_ ? peakResidentSize() : residentSize();
+  return resident_size > initial_resident_size_
+             ? resident_size - initial_resident_size_
+             : 0;
+}
+}  // namespace framework
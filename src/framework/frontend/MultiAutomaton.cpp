@@ -0,0 +1,306 @@
+#include "frontend/MultiAutomaton.hpp"
+
+#include <algorithm>
+
+#include "core/Casting.hpp"
+#include "core/Instructions.hpp"
+
+namespace framework {
+MultiAutomaton::MultiAutomaton(std::vector<framework::StateManager>& managers) {
+  for (size_t k = 0; k < managers.size() && k < kMaxDetectors; k++) {
+    managers_.push_back(&managers[k]);
+    states_.emplace_back();
+    for (auto& state : managers[k].getStates())
+      states_.back().push_back(&state);
+    state_num_ = std::max(state_num_, states_.back().size());
+  }
+
+  init_.assign(state_num_, 0);
+  bug_.assign(state_num_, 0);
+  for (size_t k = 0; k < states_.size(); k++) {
+    for (size_t index = 0; index < states_[k].size(); index++) {
+      if (states_[k][index]->isInitState()) init_[index] |= Word(1) << k;
+      if (states_[k][index]->isBugState()) bug_[index] |= Word(1) << k;
+    }
+  }
+}
+
+MultiAutomaton::Word MultiAutomaton::Candidates(
+    std::shared_ptr<framework::Function> function) {
+  if (function->isDeclaration()) return 0;
+  return analyze(function, init_).bugs;
+}
+
+const MultiAutomaton::Event& MultiAutomaton::event(const std::string& key,
+                                                   TransitionsOf transitions) {
+  if (recording_) recording_->insert(key);
+  auto found = events_.find(key);
+  if (found != events_.end()) return found->second;
+
+  Event& event = events_[key];
+  event.next.assign(state_num_, std::vector<Word>(state_num_, 0));
+  for (size_t k = 0; k < managers_.size(); k++) {
+    auto& states = states_[k];
+    auto index = [&states](const State& state) {
+      auto found = std::lower_bound(
+          states.begin(), states.end(), state,
+          [](const State* lhs, const State& rhs) { return *lhs < rhs; });
+      return found != states.end() && **found == state
+                 ? found - states.begin()
+                 : -1;
+    };
+
+    for (auto& transition : transitions(*managers_[k]->TransitionManager())) {
+      auto source = index(transition.Source());
+      auto target = index(transition.Target());
+      if (source < 0 || target < 0) continue;
+      event.next[source][target] |= Word(1) << k;
+      event.empty = false;
+    }
+  }
+  return event;
+}
+
+// The values may take the transition or not
+void MultiAutomaton::step(States& states, const Event& event) {
+  if (event.empty) return;
+  States next = states;
+  for (size_t source = 0; source < state_num_; source++) {
+    if (!states[source]) continue;
+    for (size_t target = 0; target < state_num_; target++)
+      next[target] |= states[source] & event.next[source][target];
+  }
+  states.swap(next);
+}
+
+void MultiAutomaton::closure(States& states,
+                             const std::set<std::string>& events) {
+  States previous;
+  while (previous != states) {
+    previous = states;
+    for (auto& key : events) step(states, events_[key]);
+  }
+}
+
+MultiAutomaton::Word MultiAutomaton::bugs(const States& states) const {
+  Word bugs = 0;
+  for (size_t index = 0; index < state_num_; index++)
+    bugs |= states[index] & bug_[index];
+  return bugs;
+}
+
+MultiAutomaton::Summary MultiAutomaton::analyze(
+    std::shared_ptr<framework::Function> function, const States& entry) {
+  auto key = std::make_pair(function.get(), entry);
+  auto summary = summaries_.find(key);
+  if (summary != summaries_.end()) return summary->second;
+
+  // A recursive call may run the events of the cycle in any order
+  if (active_.count(function.get())) {
+    States states = entry;
+    closure(states, Events(function));
+    return {states, bugs(states)};
+  }
+
+  auto init_block = function->InitBlock();
+  if (!init_block) return {entry, bugs(entry)};
+  active_.insert(function.get());
+
+  std::map<framework::BasicBlock*, States> outs;
+  std::map<framework::BasicBlock*, States> ins = {{init_block.get(), entry}};
+  std::vector<std::shared_ptr<framework::BasicBlock>> worklist = {init_block};
+  Word found = bugs(entry);
+  while (!worklist.empty()) {
+    auto block = worklist.back();
+    worklist.pop_back();
+
+    States states = ins[block.get()];
+    for (auto& inst : block->Instructions()) transfer(inst, states, found);
+    transferBranch(block, states);
+    found |= bugs(states);
+
+    auto out = outs.find(block.get());
+    if (out != outs.end() && out->second == states) continue;
+    outs[block.get()] = states;
+
+    for (auto& successor : block->Successors()) {
+      // The join of the paths
+      auto& successor_in = ins[successor.get()];
+      States joined = states;
+      if (!successor_in.empty()) {
+        for (size_t index = 0; index < state_num_; index++)
+          joined[index] |= successor_in[index];
+      }
+      if (joined == successor_in && outs.count(successor.get())) continue;
+      successor_in = joined;
+      worklist.push_back(successor);
+    }
+  }
+  active_.erase(function.get());
+
+  States exit = entry;
+  auto return_block = function->ReturnBlock();
+  if (return_block && outs.count(return_block.get())) {
+    exit = outs[return_block.get()];
+  } else {
+    for (auto& out : outs) {
+      for (size_t index = 0; index < state_num_; index++)
+        exit[index] |= out.second[index];
+    }
+  }
+  return summaries_[key] = {exit, found};
+}
+
+// Mirrors the transitions the Analyzer applies to an instruction
+void MultiAutomaton::transfer(std::shared_ptr<framework::Instruction> inst,
+                              States& states, Word& bugs) {
+  switch (inst->Opcode()) {
+    case llvm::Instruction::Store: {
+      auto store_inst = std::static_pointer_cast<framework::StoreInst>(inst);
+      auto value_operand = store_inst->ValueOperand();
+      if (shared_isa<framework::NullValue>(value_operand)) {
+        step(states, event("store:null", [](StateTransitionManager& manager) {
+               return manager.getStoreArgTransitions(
+                   StoreValueTransitionRule::NULL_VAL);
+             }));
+      } else {
+        step(states,
+             event("store:non-null", [](StateTransitionManager& manager) {
+               return manager.getStoreArgTransitions(
+                   StoreValueTransitionRule::NON_NULL_VAL);
+             }));
+      }
+
+      auto call_inst = shared_dyn_cast<framework::CallInst>(value_operand);
+      if (call_inst && call_inst->CalledFunction()) {
+        std::string name = call_inst->CalledFunction()->Name();
+        step(states, event("store:call:" + name,
+                           [&name](StateTransitionManager& manager) {
+                             return manager.getStoreArgTransitions(
+                                 StoreValueTransitionRule::CALL_FUNC, name);
+                           }));
+      }
+
+      step(states, event("store:any", [](StateTransitionManager& manager) {
+             return manager.getStoreArgTransitions(
+                 StoreValueTransitionRule::ANY);
+           }));
+      step(states, event("alias", [](StateTransitionManager& manager) {
+             return manager.getAliasTransitions();
+           }));
+      return;
+    }
+    case llvm::Instruction::Load:
+      step(states, event("use", [](StateTransitionManager& manager) {
+             return manager.getUseValueTransitions();
+           }));
+      return;
+    case llvm::Instruction::Call:
+      break;
+    default:
+      return;
+  }
+
+  auto call_inst = std::static_pointer_cast<framework::CallInst>(inst);
+  auto function = call_inst->CalledFunction();
+  if (!function || transferArguments(call_inst, states) ||
+      function->isDebugFunction())
+    return;
+
+  if (Function::IsMemSetFunction(function)) {
+    step(states, event("store:any", [](StateTransitionManager& manager) {
+           return manager.getStoreArgTransitions(StoreValueTransitionRule::ANY);
+         }));
+    return;
+  }
+  if (function->isDeclaration()) return;
+
+  auto summary = analyze(function, states);
+  bugs |= summary.bugs;
+  for (size_t index = 0; index < state_num_; index++)
+    states[index] |= summary.exit[index];
+}
+
+// True when the function has transitions on its arguments, which then stand
+// for the call
+bool MultiAutomaton::transferArguments(
+    std::shared_ptr<framework::CallInst> call_inst, States& states) {
+  bool transition_function = false;
+  std::string name = call_inst->CalledFunction()->Name();
+  for (unsigned arg = 0; arg < call_inst->Arguments().size(); arg++) {
+    auto& call_event =
+        event("call:" + name + ":" + std::to_string(arg),
+              [&name, arg](StateTransitionManager& manager) {
+                return manager.getFunctionArgTransitions(name, arg).second;
+              });
+    transition_function |= !call_event.empty;
+    step(states, call_event);
+  }
+  return transition_function;
+}
+
+// Both sides of a null check, since the values are not told apart
+void MultiAutomaton::transferBranch(
+    std::shared_ptr<framework::BasicBlock> block, States& states) {
+  auto branch_inst = block->getBranchInst();
+  if (!branch_inst || !branch_inst->Condition() ||
+      !shared_isa<framework::CompareInst>(branch_inst->Condition()))
+    return;
+
+  step(states, event("branch", [](StateTransitionManager& manager) {
+         auto transitions = manager.getStoreArgTransitions(
+             StoreValueTransitionRule::NULL_BRANCH_CONSIDERED_ANY);
+         for (auto type : {StoreValueTransitionRule::NULL_BRANCH_CONSIDERED_NULL,
+                           StoreValueTransitionRule::
+                               NULL_BRANCH_CONSIDERED_NON_NULL}) {
+           auto typed = manager.getStoreArgTransitions(type);
+           transitions.insert(transitions.end(), typed.begin(), typed.end());
+         }
+         return transitions;
+       }));
+}
+
+// The events of the function and of everything it calls
+const std::set<std::string>& MultiAutomaton::Events(
+    std::shared_ptr<framework::Function> function) {
+  auto found = function_events_.find(function.get());
+  if (found != function_events_.end()) return found->second;
+
+  std::set<std::string> events;
+  auto recording = recording_;
+  recording_ = &events;
+
+  std::set<framework::Function*> visited;
+  std::vector<std::shared_ptr<framework::Function>> functions = {function};
+  while (!functions.empty()) {
+    auto current = functions.back();
+    functions.pop_back();
+    if (!visited.insert(current.get()).second) continue;
+
+    // Only the events are of interest, the callees are walked instead of
+    // analyzed
+    States states = init_;
+    Word bugs = 0;
+    for (auto& block : current->BasicBlocks()) {
+      for (auto& inst : block->Instructions()) {
+        auto call_inst = shared_dyn_cast<framework::CallInst>(inst);
+        if (!call_inst) {
+          transfer(inst, states, bugs);
+          continue;
+        }
+
+        auto callee = call_inst->CalledFunction();
+        if (!callee || transferArguments(call_inst, states)) continue;
+        if (Function::IsMemSetFunction(callee))
+          transfer(inst, states, bugs);
+        else if (!callee->isDeclaration())
+          functions.push_back(callee);
+      }
+      transferBranch(block, states);
+    }
+  }
+
+  recording_ = recording;
+  return function_events_[function.get()] = events;
+}
+}  // namespace framework
@@ -0,0 +1,168 @@
+#include "frontend/Query.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "core/Casting.hpp"
+#include "llvm/IR/DebugInfoMetadata.h"
+
+namespace framework {
+Query::Query(const std::string& location) : location_(location) {
+  // Split the numbers off from the right, since the file may hold colons
+  std::vector<unsigned> numbers;
+  std::string file = location;
+  for (int i = 0; i < 2; i++) {
+    size_t colon = file.rfind(':');
+    if (colon == std::string::npos) break;
+    std::string number = file.substr(colon + 1);
+    if (number.empty() ||
+        number.find_first_not_of("0123456789") != std::string::npos)
+      break;
+    numbers.insert(numbers.begin(), std::strtoul(number.c_str(), nullptr, 10));
+    file = file.substr(0, colon);
+  }
+  if (numbers.empty() || file.empty()) return;
+
+  file_ = file;
+  line_ = numbers[0];
+  if (numbers.size() > 1) column_ = numbers[1];
+}
+
+bool Query::matches(framework::Instruction* inst) const {
+  const llvm::DebugLoc& loc = inst->getDebugLoc();
+  if (!loc || loc.getLine() != line_) return false;
+  if (column_ && loc.getCol() != column_) return false;
+
+  // Either of the paths may be relative
+  std::string file = loc->getFilename().str();
+  auto ends_with = [](const std::string& path, const std::string& suffix) {
+    return path.size() >= suffix.size() &&
+           path.compare(path.size() - suffix.size(), suffix.size(), suffix) ==
+               0 &&
+           (path.size() == suffix.size() ||
+            path[path.size() - suffix.size() - 1] == '/');
+  };
+  return ends_with(file, file_) || ends_with(file_, file);
+}
+
+bool Query::isQueriedValue(
+    const std::shared_ptr<framework::Value>& value) const {
+  return std::find_if(values_.begin(), values_.end(), [&value](auto& queried) {
+           return queried == value || *queried == *value;
+         }) != values_.end();
+}
+
+bool Query::isDemanded(framework::BasicBlock* block) const {
+  auto function = block->Parent().lock();
+  if (!function || !functions_.count(function.get())) return true;
+  return blocks_.count(block);
+}
+
+void Query::collect(
+    const std::vector<std::shared_ptr<framework::Function>>& functions) {
+  for (auto& function : functions) {
+    std::vector<std::shared_ptr<framework::BasicBlock>> blocks;
+    std::set<uint64_t> arguments;
+    for (auto& block : function->BasicBlocks()) {
+      bool matched = false;
+      for (auto& inst : block->Instructions()) {
+        if (!matches(inst.get())) continue;
+        matched = true;
+        instructions_.push_back(inst);
+        for (auto& value : UsedValues(inst)) {
+          values_.push_back(value);
+          if (auto argument = shared_dyn_cast<framework::Argument>(value))
+            arguments.insert(argument->ArgNum());
+        }
+      }
+      if (matched) blocks.push_back(block);
+    }
+    if (blocks.empty()) continue;
+
+    // The states at the location, and what becomes of them
+    addBlocks(function, blocks, false);
+    addBlocks(function, blocks, true);
+    addCallers(function, arguments);
+  }
+}
+
+void Query::addBlocks(
+    std::shared_ptr<framework::Function> function,
+    std::vector<std::shared_ptr<framework::BasicBlock>> blocks, bool forward) {
+  if (functions_.insert(function.get()).second) entries_.push_back(function);
+
+  // Every ancestor, however far back
+  if (!forward) {
+    auto& reachability = function->BlockReachability();
+    for (auto& block : function->BasicBlocks()) {
+      for (auto& location : blocks) {
+        if (block != location && !reachability.isAncestor(block, location))
+          continue;
+        blocks_.insert(block.get());
+        break;
+      }
+    }
+    return;
+  }
+
+  std::set<framework::BasicBlock*> visited;
+  while (!blocks.empty()) {
+    auto block = blocks.back();
+    blocks.pop_back();
+    if (!visited.insert(block.get()).second) continue;
+    blocks_.insert(block.get());
+
+    for (auto& next : block->Successors()) blocks.push_back(next);
+  }
+}
+
+// The arguments come in from the callers, as far up as they are still
+// arguments, and go on in the callers after the calls
+void Query::addCallers(std::shared_ptr<framework::Function> function,
+                       std::set<uint64_t> arguments) {
+  for (auto argument : arguments) {
+    if (!walked_arguments_.insert({function.get(), argument}).second) continue;
+
+    for (auto& caller : function->CallerFunctions()) {
+      std::vector<std::shared_ptr<framework::BasicBlock>> blocks;
+      std::set<uint64_t> caller_arguments;
+      for (auto& block : caller->BasicBlocks()) {
+        bool calls = false;
+        for (auto& inst : block->Instructions()) {
+          auto call_inst = shared_dyn_cast<framework::CallInst>(inst);
+          if (!call_inst || call_inst->CalledFunction() != function ||
+              argument >= call_inst->Arguments().size())
+            continue;
+          calls = true;
+          auto& actual = call_inst->Arguments()[argument];
+          values_.push_back(actual);
+          if (auto caller_argument =
+                  shared_dyn_cast<framework::Argument>(actual))
+            caller_arguments.insert(caller_argument->ArgNum());
+        }
+        if (calls) blocks.push_back(block);
+      }
+      if (blocks.empty()) continue;
+
+      addBlocks(caller, blocks, false);
+      addBlocks(caller, blocks, true);
+      addCallers(caller, caller_arguments);
+    }
+  }
+}
+
+std::vector<std::shared_ptr<framework::Value>> Query::UsedValues(
+    std::shared_ptr<framework::Instruction> inst) {
+  switch (inst->Opcode()) {
+    case llvm::Instruction::Call:
+      return std::static_pointer_cast<framework::CallInst>(inst)->Arguments();
+    case llvm::Instruction::Store:
+      return {
+          std::static_pointer_cast<framework::StoreInst>(inst)->PointerOperand()};
+    case llvm::Instruction::Load:
+      return {std::static_pointer_cast<framework::LoadInst>(inst)->LoadValue()};
+    default:
+      return {};
+  }
+}
+}  // namespace framework
@@ -437,4 +437,38 @@ std::vector<framework::Transition>
 StateTransitionManager::getAliasTransitions() {
   return alias_transitions_;
 }
+
+bool StateTransitionManager::isTransitionFunction(const std::string& name) {
+  auto arg = function_transitions_.lower_bound(
+      FunctionArgTransitionRule::FunctionArg(name, 0));
+  if (arg != function_transitions_.end() && arg->first.function_name == name)
+    return true;
+  return call_store_transitions_.find(name) != call_store_transitions_.end();
+}
+
+std::vector<framework::Transition>
+StateTransitionManager::getCallTransitions() {
+  std::vector<framework::Transition> transitions;
+  for (auto &function : function_transitions_)
+    transitions.insert(transitions.end(), function.second.begin(),
+                       function.second.end());
+  for (auto &function : call_store_transitions_)
+    transitions.insert(transitions.end(), function.second.begin(),
+                       function.second.end());
+  return transitions;
+}
+
+std::vector<framework::Transition>
+StateTransitionManager::getValueTransitions() {
+  std::vector<framework::Transition> transitions(use_transitions_);
+  transitions.insert(transitions.end(), alias_transitions_.begin(),
+                     alias_transitions_.end());
+  for (auto &store : store_transitions_) {
+    if (store.first == framework::StoreValueTransitionRule::CALL_FUNC)
+      continue;
+    transitions.insert(transitions.end(), store.second.begin(),
+                       store.second.end());
+  }
+  return transitions;
+}
 };  // namespace framework
@@ -0,0 +1,242 @@
+#include "frontend/Supervisor.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+
+#include "frontend/Daemon.hpp"
+#include "frontend/MemoryGovernor.hpp"
+
+namespace framework {
+static constexpr auto kPollInterval = std::chrono::milliseconds(500);
+
+// In a worker, the write ends of its pipes to the supervisor
+static int worker_pipes[2] = {-1, -1};
+
+Supervisor::Supervisor(const std::string& module_name, const Limits& limits)
+    : module_name_(module_name), limits_(limits) {}
+
+void Supervisor::applyLimits() {
+  if (limits_.cpu_seconds) {
+    // SIGXCPU at the soft limit, SIGKILL a second later
+    struct rlimit cpu = {limits_.cpu_seconds, limits_.cpu_seconds + 1};
+    setrlimit(RLIMIT_CPU, &cpu);
+  }
+
+  if (limits_.address_space) {
+    long pages = 0;
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm) {
+      if (fscanf(statm, "%ld", &pages) != 1) pages = 0;
+      fclose(statm);
+    }
+    rlim_t size = pages * sysconf(_SC_PAGESIZE) + limits_.address_space;
+    struct rlimit address_space = {size, size};
+    setrlimit(RLIMIT_AS, &address_space);
+  }
+}
+
+int Supervisor::spawn(const std::string& name, Task task) {
+  int log_pipe[2], heartbeat_pipe[2];
+  if (pipe2(log_pipe, O_CLOEXEC) < 0) return -1;
+  if (pipe2(heartbeat_pipe, O_CLOEXEC) < 0) {
+    close(log_pipe[0]);
+    close(log_pipe[1]);
+    return -1;
+  }
+
+  // The worker starts with the resident set of this process
+  uint64_t resident_size = MemoryGovernor::residentSize();
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(log_pipe[0]);
+    close(heartbeat_pipe[0]);
+    worker_pipes[0] = log_pipe[1];
+    worker_pipes[1] = heartbeat_pipe[1];
+    // The worker and the processes it forks are killed as a group. Out of
+    // the group of the compiler, it follows the compiler if that one is
+    // interrupted.
+    setpgid(0, 0);
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+    // Its peak is measured from there, not from the peak inherited by some
+    // kernels
+    MemoryGovernor::resetPeakResidentSize();
+    applyLimits();
+
+    std::string log;
+    LoggingClient client(log);
+    auto flush_log = [&log, &log_pipe]() {
+      daemon::writeAll(log_pipe[1], log.data(), log.size());
+      log.clear();
+    };
+
+    task(client, [&](const std::string& function) {
+      flush_log();
+      std::string line = function + "\n";
+      daemon::writeAll(heartbeat_pipe[1], line.data(), line.size());
+    });
+    client.flush();
+    flush_log();
+    exit(0);
+  }
+
+  close(log_pipe[1]);
+  close(heartbeat_pipe[1]);
+  if (pid < 0) {
+    close(log_pipe[0]);
+    close(heartbeat_pipe[0]);
+    return -1;
+  }
+  // Also here, so that the group exists before the first kill
+  setpgid(pid, pid);
+
+  auto worker = std::make_unique<Worker>();
+  worker->id = next_id_++;
+  worker->name = name;
+  worker->pid = pid;
+  worker->initial_resident_size = resident_size;
+  worker->log_fd = log_pipe[0];
+  worker->heartbeat_fd = heartbeat_pipe[0];
+  worker->start = worker->last_heartbeat = std::chrono::steady_clock::now();
+  workers_.push_back(std::move(worker));
+  return workers_.back()->id;
+}
+
+bool Supervisor::readWorker(Worker& worker, int fd) {
+  char buffer[4096];
+  ssize_t size = read(fd, buffer, sizeof(buffer));
+  if (size < 0 && errno == EINTR) return true;
+  if (size <= 0) return false;
+
+  if (fd == worker.log_fd) {
+    worker.log.append(buffer, size);
+    return true;
+  }
+
+  worker.last_heartbeat = std::chrono::steady_clock::now();
+  worker.heartbeat.append(buffer, size);
+  size_t end = worker.heartbeat.rfind('\n');
+  if (end != std::string::npos) {
+    size_t begin = worker.heartbeat.rfind('\n', end - 1);
+    begin = begin == std::string::npos ? 0 : begin + 1;
+    worker.current_function = worker.heartbeat.substr(begin, end - begin);
+    worker.heartbeat.erase(0, end + 1);
+  }
+  return true;
+}
+
+void Supervisor::killStalledWorkers() {
+  auto now = std::chrono::steady_clock::now();
+  for (auto& worker : workers_) {
+    if (worker->kill_reason) continue;
+
+    if (limits_.timeout &&
+        now - worker->start > std::chrono::seconds(limits_.timeout))
+      worker->kill_reason = "timeout";
+    else if (limits_.stall_timeout &&
+             now - worker->last_heartbeat >
+                 std::chrono::seconds(limits_.stall_timeout))
+      worker->kill_reason = "stalled";
+    else
+      continue;
+
+    kill(-worker->pid, SIGKILL);
+  }
+}
+
+void Supervisor::closeWorkerPipes() {
+  for (auto& fd : worker_pipes) {
+    if (fd < 0) continue;
+    close(fd);
+    fd = -1;
+  }
+}
+
+void Supervisor::reapWorker(size_t index, llvm::raw_ostream& output,
+                            Worker& finished) {
+  Worker& worker = *workers_[index];
+  close(worker.log_fd);
+  close(worker.heartbeat_fd);
+
+  int status = 0;
+  struct rusage usage;
+  while (wait4(worker.pid, &status, 0, &usage) < 0 && errno == EINTR) {
+  }
+  worker.max_resident_size = static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+
+  const char* reason = worker.kill_reason;
+  if (!reason && WIFSIGNALED(status)) {
+    switch (WTERMSIG(status)) {
+      case SIGXCPU:
+      case SIGKILL:
+        reason = limits_.cpu_seconds ? "cpu limit" : "killed";
+        break;
+      default:
+        reason = limits_.address_space ? "memory limit or crash" : "crash";
+        break;
+    }
+  } else if (!reason && WIFEXITED(status) && WEXITSTATUS(status) != 0) {
+    reason = "failed";
+  }
+  // The processes the worker forked do not outlive it
+  if (reason) kill(-worker.pid, SIGKILL);
+
+  output << worker.log;
+  if (reason) {
+    output << "[ABORTED] module=" << module_name_ << " analyzer=" << worker.name
+           << " function="
+           << (worker.current_function.empty() ? "-" : worker.current_function)
+           << " reason=" << reason << "\n";
+  }
+  output.flush();
+
+  finished = worker;
+  workers_.erase(workers_.begin() + index);
+}
+
+bool Supervisor::waitAny(llvm::raw_ostream& output, Worker& finished) {
+  while (!workers_.empty()) {
+    std::vector<struct pollfd> fds;
+    for (auto& worker : workers_) {
+      fds.push_back({worker->log_fd, POLLIN, 0});
+      fds.push_back({worker->heartbeat_fd, POLLIN, 0});
+    }
+
+    bool watchdog = limits_.timeout || limits_.stall_timeout;
+    int result = poll(fds.data(), fds.size(),
+                      watchdog ? kPollInterval.count() : -1);
+    if (result < 0 && errno != EINTR) return false;
+    killStalledWorkers();
+    if (result <= 0) continue;
+
+    for (size_t i = 0; i < workers_.size(); i++) {
+      bool open = false;
+      for (int j = 0; j < 2; j++) {
+        auto& fd = fds[i * 2 + j];
+        if (fd.fd < 0) continue;
+        if (!fd.revents || readWorker(*workers_[i], fd.fd)) {
+          open = true;
+          continue;
+        }
+        // Closed, but keep it out of the next poll of this round
+        fd.fd = -1;
+      }
+
+      // Both channels are closed once the worker is gone
+      if (!open) {
+        reapWorker(i, output, finished);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+}  // namespace framework
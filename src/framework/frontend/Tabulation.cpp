@@ -0,0 +1,498 @@
+#include "frontend/Tabulation.hpp"
+
+#include <algorithm>
+
+#include "core/Casting.hpp"
+#include "core/Utils.hpp"
+#include "llvm/IR/Instruction.h"
+
+namespace framework {
+TabulationSolver::TabulationSolver(framework::StateManager& state_manager,
+                                   framework::LoggingClient& log, bool flex)
+    : state_manager_(state_manager), log_(log), flex_(flex) {
+  for (auto& state : state_manager_.getStates()) {
+    if (state.isInitState()) init_state_ = &state;
+  }
+}
+
+void TabulationSolver::solve(
+    const std::vector<std::shared_ptr<framework::Function>>& functions) {
+  if (!init_state_) return;
+
+  // Every function is an entry point with its arguments in the init state, as
+  // in the dense analysis
+  Fact seed = {nullptr, nullptr};
+  for (auto& function : functions) {
+    if (function->isDeclaration() || !function->InitBlock()) continue;
+    propagate(seed, {function->InitBlock(), 0}, seed);
+  }
+
+  while (!worklist_.empty()) {
+    PathEdge edge = worklist_.back();
+    worklist_.pop_back();
+
+    auto& instructions = Instructions(edge.node.block);
+    if (edge.node.index == instructions.size()) {
+      processBlockEnd(edge);
+      continue;
+    }
+
+    auto inst = instructions[edge.node.index];
+    Node next = {edge.node.block, edge.node.index + 1};
+    if (inst->Opcode() == llvm::Instruction::Call) {
+      auto call_inst = std::static_pointer_cast<framework::CallInst>(inst);
+      if (analyzedCallee(call_inst)) {
+        processCall(edge, call_inst);
+        continue;
+      }
+    }
+
+    for (auto& fact : flowInstruction(inst, edge.fact))
+      propagate(edge.entry, next, fact);
+  }
+}
+
+void TabulationSolver::propagate(const Fact& entry, const Node& node,
+                                 const Fact& fact) {
+  if (query_ && !query_->isDemanded(node.block.get())) return;
+
+  PathEdge edge = {entry, node, fact};
+  if (!path_edges_.insert(edge).second) return;
+  worklist_.push_back(edge);
+
+  // The values of a function start in the init state, except the arguments
+  // a caller hands over
+  auto function = node.block->Parent().lock();
+  if (fact.isZero() && node.index == 0 && function &&
+      node.block == function->InitBlock()) {
+    for (auto& entry_fact : flowEntry(function, !fact.state))
+      propagate(entry, node, entry_fact);
+  }
+}
+
+void TabulationSolver::processCall(
+    const PathEdge& edge, std::shared_ptr<framework::CallInst> call_inst) {
+  auto callee = call_inst->CalledFunction();
+  Node next = {edge.node.block, edge.node.index + 1};
+
+  for (auto& callee_fact : flowCallToStart(call_inst, edge.fact)) {
+    Context context = {callee, callee_fact};
+    incoming_[context].insert(edge);
+    propagate(callee_fact, {callee->InitBlock(), 0}, callee_fact);
+
+    // Reuse the exit facts already known for this entry fact
+    auto summary = end_summaries_.find(context);
+    if (summary == end_summaries_.end()) continue;
+    for (auto& exit_fact : summary->second) {
+      for (auto& fact :
+           flowExitToReturn(edge, call_inst, callee_fact, exit_fact))
+        propagate(edge.entry, next, fact);
+    }
+  }
+
+  // The facts handed over come back through the exit of the callee
+  if (!passedToCallee(call_inst, edge.fact))
+    propagate(edge.entry, next, edge.fact);
+}
+
+void TabulationSolver::processExit(const PathEdge& edge) {
+  auto function = edge.node.block->Parent().lock();
+  if (!function) return;
+
+  if (edge.fact.logs) {
+    auto inst = edge.fact.logs->CurrentInstruction();
+    report(edge.fact, inst, BugNotificationTiming::FUNCTION_END, function);
+    if (function->CallerFunctions().empty())
+      report(edge.fact, inst, BugNotificationTiming::MODULE_END, function);
+  }
+
+  Context context = {function, edge.entry};
+  if (!end_summaries_[context].insert(edge.fact).second) return;
+
+  for (auto& caller : incoming_[context]) {
+    auto call_inst = std::static_pointer_cast<framework::CallInst>(
+        Instructions(caller.node.block)[caller.node.index]);
+    Node next = {caller.node.block, caller.node.index + 1};
+    for (auto& fact :
+         flowExitToReturn(caller, call_inst, edge.entry, edge.fact))
+      propagate(caller.entry, next, fact);
+  }
+}
+
+void TabulationSolver::processBlockEnd(const PathEdge& edge) {
+  auto block = edge.node.block;
+  if (edge.fact.logs) {
+    auto dead_values = block->DeadValues();
+    if (dead_values.find(edge.fact.value) != dead_values.end()) {
+      report(edge.fact, edge.fact.logs->CurrentInstruction(),
+             BugNotificationTiming::END_OF_LIFE);
+    }
+  }
+
+  auto function = block->Parent().lock();
+  if (function && block == function->ReturnBlock()) {
+    processExit(edge);
+    return;
+  }
+
+  for (auto& successor : block->Successors()) {
+    for (auto& fact : flowEdge(block, successor, edge.fact))
+      propagate(edge.entry, {successor, 0}, fact);
+  }
+}
+
+std::vector<TabulationSolver::Fact> TabulationSolver::flowEntry(
+    std::shared_ptr<framework::Function> function, bool arguments) {
+  std::vector<Fact> facts;
+  for (auto& value : touchedValues(function)) {
+    if (!arguments && shared_isa<framework::Argument>(value)) continue;
+    facts.push_back({value, init_state_});
+  }
+  return facts;
+}
+
+std::vector<TabulationSolver::Fact> TabulationSolver::flowInstruction(
+    std::shared_ptr<framework::Instruction> inst, const Fact& fact) {
+  if (fact.isZero()) return {fact};
+
+  auto transition_manager = state_manager_.TransitionManager();
+  switch (inst->Opcode()) {
+    case llvm::Instruction::Store: {
+      auto store_inst = std::static_pointer_cast<framework::StoreInst>(inst);
+      auto value_operand = store_inst->ValueOperand();
+      auto transitions = transition_manager->getStoreArgTransitions(
+          shared_isa<framework::NullValue>(value_operand)
+              ? StoreValueTransitionRule::NULL_VAL
+              : StoreValueTransitionRule::NON_NULL_VAL);
+
+      auto call_inst = shared_dyn_cast<framework::CallInst>(value_operand);
+      if (call_inst && call_inst->CalledFunction()) {
+        auto call_transitions = transition_manager->getStoreArgTransitions(
+            StoreValueTransitionRule::CALL_FUNC,
+            call_inst->CalledFunction()->Name());
+        transitions.insert(transitions.end(), call_transitions.begin(),
+                           call_transitions.end());
+      }
+
+      auto any_transitions = transition_manager->getStoreArgTransitions(
+          StoreValueTransitionRule::ANY);
+      transitions.insert(transitions.end(), any_transitions.begin(),
+                         any_transitions.end());
+      return {transit(fact, store_inst->PointerOperand(), transitions, inst)};
+    }
+    case llvm::Instruction::Load: {
+      auto load_inst = std::static_pointer_cast<framework::LoadInst>(inst);
+      return {transit(fact, load_inst->LoadValue(),
+                      transition_manager->getUseValueTransitions(), inst)};
+    }
+    case llvm::Instruction::Call:
+      break;
+    default:
+      return {fact};
+  }
+
+  auto call_inst = std::static_pointer_cast<framework::CallInst>(inst);
+  auto function = call_inst->CalledFunction();
+  auto& arguments = call_inst->Arguments();
+
+  if (function) {
+    bool transition_function = false;
+    Fact result = fact;
+    for (size_t arg = 0; arg < arguments.size(); arg++) {
+      auto transitions =
+          transition_manager->getFunctionArgTransitions(function->Name(), arg)
+              .second;
+      if (transitions.empty()) continue;
+      transition_function = true;
+      result = transit(result, arguments[arg], transitions, inst);
+    }
+    if (transition_function) return {result};
+
+    if (function->isDebugFunction()) {
+      // A new declaration of the value resets its state
+      if (Function::IsDebugDeclareFunction(function) && !arguments.empty() &&
+          *fact.value == *arguments[0])
+        return {rename(fact, fact.value)};
+      return {fact};
+    }
+
+    if (Function::IsMemSetFunction(function) && !arguments.empty()) {
+      return {transit(fact, arguments[0],
+                      transition_manager->getStoreArgTransitions(
+                          StoreValueTransitionRule::ANY),
+                      inst)};
+    }
+  }
+
+  // Unknown callees take the values over, like the dense analysis does
+  for (auto& argument : arguments) {
+    if (*fact.value == *argument) return {{fact.value, init_state_}};
+  }
+  return {fact};
+}
+
+std::vector<TabulationSolver::Fact> TabulationSolver::flowEdge(
+    std::shared_ptr<framework::BasicBlock> block,
+    std::shared_ptr<framework::BasicBlock> successor, const Fact& fact) {
+  auto branch_inst = block->getBranchInst();
+  if (fact.isZero() || !branch_inst || !branch_inst->Condition()) return {fact};
+
+  auto compare_inst =
+      shared_dyn_cast<framework::CompareInst>(branch_inst->Condition());
+  if (!compare_inst) return {fact};
+
+  bool null_exists = false;
+  std::shared_ptr<framework::Value> compared;
+  for (auto& operand : compare_inst->Operands()) {
+    if (shared_isa<framework::NullValue>(operand))
+      null_exists = true;
+    else if (!shared_isa<framework::ConstValue>(operand))
+      compared = operand;
+  }
+  if (!null_exists || !compared) return {fact};
+
+  auto null_nodes = compare_inst->GetPredicate() == llvm::CmpInst::ICMP_EQ
+                        ? branch_inst->TruePathNodes()
+                        : branch_inst->FalsePathNodes();
+  bool null_path =
+      std::find_if(null_nodes.begin(), null_nodes.end(), [&](auto node) {
+        return node.lock() == successor;
+      }) != null_nodes.end();
+
+  auto transition_manager = state_manager_.TransitionManager();
+  auto transitions = transition_manager->getStoreArgTransitions(
+      StoreValueTransitionRule::NULL_BRANCH_CONSIDERED_ANY);
+  auto path_transitions = transition_manager->getStoreArgTransitions(
+      null_path ? StoreValueTransitionRule::NULL_BRANCH_CONSIDERED_NULL
+                : StoreValueTransitionRule::NULL_BRANCH_CONSIDERED_NON_NULL);
+  transitions.insert(transitions.end(), path_transitions.begin(),
+                     path_transitions.end());
+  return {transit(fact, compared, transitions, branch_inst)};
+}
+
+std::vector<TabulationSolver::Fact> TabulationSolver::flowCallToStart(
+    std::shared_ptr<framework::CallInst> call_inst, const Fact& fact) {
+  if (fact.isZero()) return {{nullptr, init_state_}};
+
+  std::vector<Fact> facts;
+  auto& arguments = call_inst->Arguments();
+  for (auto& value : touchedValues(call_inst->CalledFunction())) {
+    auto argument = shared_dyn_cast<framework::Argument>(value);
+    if (!argument || argument->ArgNum() >= arguments.size()) continue;
+
+    auto caller_value =
+        Value::CreateAppend(arguments[argument->ArgNum()], value);
+    if (!(*caller_value == *fact.value)) continue;
+
+    // The callee starts over with the fact as its entry fact, and with the
+    // trace of the first call handing it over
+    facts.push_back(rename(fact, value));
+  }
+  return facts;
+}
+
+std::vector<TabulationSolver::Fact> TabulationSolver::flowExitToReturn(
+    const PathEdge& caller, std::shared_ptr<framework::CallInst> call_inst,
+    const Fact& exit_entry, const Fact& fact) {
+  // The zero fact already goes around the call
+  if (fact.isZero()) return {};
+
+  auto callee = call_inst->CalledFunction();
+  std::shared_ptr<framework::Value> value;
+  if (callee->getReturnValue() && *fact.value == *callee->getReturnValue()) {
+    value = call_inst;
+  } else {
+    // The locals of the callee do not outlive it
+    auto argument = shared_dyn_cast<framework::Argument>(fact.value);
+    auto& arguments = call_inst->Arguments();
+    if (!argument || argument->ArgNum() >= arguments.size()) return {};
+    value = Value::CreateAppend(arguments[argument->ArgNum()], fact.value);
+  }
+
+  // The caller goes on with its own trace, where the callee is one transition
+  // at the call, as in the dense analysis. The trace of the callee belongs to
+  // the first call that reached it.
+  Fact caller_fact = {value, fact.state, caller.fact.logs};
+  const State* entry_state =
+      exit_entry.isZero() ? init_state_ : exit_entry.state;
+  if (fact.state == entry_state) return {caller_fact};
+
+  Transition reduced(*entry_state, *fact.state);
+  std::shared_ptr<TransitionLogs> logs;
+  if (caller.fact.logs && !entry_state->isInitState()) {
+    logs = std::make_shared<TransitionLogs>(*caller.fact.logs);
+    logs->addTransition(reduced, call_inst);
+  } else {
+    logs = std::make_shared<TransitionLogs>(reduced, call_inst);
+  }
+  caller_fact.logs = logs;
+  return {caller_fact};
+}
+
+bool TabulationSolver::passedToCallee(
+    std::shared_ptr<framework::CallInst> call_inst, const Fact& fact) {
+  if (fact.isZero()) return false;
+
+  auto& arguments = call_inst->Arguments();
+  for (auto& value : touchedValues(call_inst->CalledFunction())) {
+    auto argument = shared_dyn_cast<framework::Argument>(value);
+    if (argument && argument->ArgNum() < arguments.size() &&
+        *Value::CreateAppend(arguments[argument->ArgNum()], value) ==
+            *fact.value)
+      return true;
+  }
+  return false;
+}
+
+TabulationSolver::Fact TabulationSolver::transit(
+    const Fact& fact, std::shared_ptr<framework::Value> value,
+    const std::vector<Transition>& transitions,
+    std::shared_ptr<framework::Instruction> inst) {
+  if (fact.isZero() || value->isGlobalVar() || !(*fact.value == *value))
+    return fact;
+
+  // The first transition leaving the state, or the least target from the
+  // init state
+  const Transition* transition = nullptr;
+  for (auto& candidate : transitions) {
+    if (!(candidate.Source() == *fact.state)) continue;
+    if (!fact.state->isInitState()) {
+      transition = &candidate;
+      break;
+    }
+    if (!transition || candidate.Target() < transition->Target())
+      transition = &candidate;
+  }
+  if (!transition) return fact;
+
+  const State* target = getState(transition->Target());
+  if (target == fact.state) return fact;
+
+  // The path goes on with its own trace, whichever path reached the fact
+  // first
+  Transition logged = *transition;
+  std::shared_ptr<TransitionLogs> logs;
+  if (fact.logs && !fact.state->isInitState()) {
+    logs = std::make_shared<TransitionLogs>(*fact.logs);
+    logs->addTransition(logged, inst);
+  } else {
+    logs = std::make_shared<TransitionLogs>(logged, inst);
+  }
+
+  Fact next = {fact.value, target, logs};
+  report(next, inst, BugNotificationTiming::IMMEDIATE);
+  return next;
+}
+
+TabulationSolver::Fact TabulationSolver::rename(
+    const Fact& fact, std::shared_ptr<framework::Value> value) {
+  if (value == fact.value) return {value, init_state_};
+  return {value, fact.state, fact.logs};
+}
+
+bool TabulationSolver::analyzedCallee(
+    std::shared_ptr<framework::CallInst> call_inst) {
+  auto function = call_inst->CalledFunction();
+  if (!function || function->isDeclaration() || function->isDebugFunction() ||
+      !function->InitBlock())
+    return false;
+
+  auto transition_manager = state_manager_.TransitionManager();
+  for (size_t arg = 0; arg < call_inst->Arguments().size(); arg++) {
+    if (!transition_manager->getFunctionArgTransitions(function->Name(), arg)
+             .second.empty())
+      return false;
+  }
+  return true;
+}
+
+const std::vector<std::shared_ptr<framework::Instruction>>&
+TabulationSolver::Instructions(std::shared_ptr<framework::BasicBlock> block) {
+  auto instructions = instructions_.find(block.get());
+  if (instructions != instructions_.end()) return instructions->second;
+  return instructions_[block.get()] = block->Instructions();
+}
+
+// The values whose state an instruction of the function may change, along
+// with the values its callees change through the arguments, the way
+// copyFunctionValues hands them to the caller
+const std::vector<std::shared_ptr<framework::Value>>&
+TabulationSolver::touchedValues(std::shared_ptr<framework::Function> function) {
+  auto touched = touched_values_.find(function);
+  if (touched != touched_values_.end()) return touched->second;
+
+  // A recursive call sees the values found so far
+  auto& values = touched_values_[function];
+  auto add_value = [&values](std::shared_ptr<framework::Value> value) {
+    if (!value || value->isGlobalVar() ||
+        shared_isa<framework::ConstValue>(value) ||
+        shared_isa<framework::NullValue>(value))
+      return;
+    if (std::find_if(values.begin(), values.end(), [&value](auto& added) {
+          return *added == *value;
+        }) == values.end())
+      values.push_back(value);
+  };
+
+  for (auto& block : function->BasicBlocks()) {
+    for (auto& inst : Instructions(block)) {
+      for (auto& value : Query::UsedValues(inst)) add_value(value);
+
+      auto call_inst = shared_dyn_cast<framework::CallInst>(inst);
+      if (!call_inst || !analyzedCallee(call_inst)) continue;
+      auto& arguments = call_inst->Arguments();
+      auto callee_values = touchedValues(call_inst->CalledFunction());
+      for (auto& value : callee_values) {
+        auto argument = shared_dyn_cast<framework::Argument>(value);
+        if (argument && argument->ArgNum() < arguments.size())
+          add_value(Value::CreateAppend(arguments[argument->ArgNum()], value));
+      }
+    }
+
+    auto branch_inst = block->getBranchInst();
+    if (!branch_inst || !branch_inst->Condition()) continue;
+    if (auto compare_inst =
+            shared_dyn_cast<framework::CompareInst>(branch_inst->Condition())) {
+      for (auto& operand : compare_inst->Operands()) add_value(operand);
+    }
+  }
+  return values;
+}
+
+const framework::State* TabulationSolver::getState(
+    const framework::State& state) {
+  auto& states = state_manager_.getStates();
+  auto found = states.find(state);
+  return found == states.end() ? init_state_ : &*found;
+}
+
+void TabulationSolver::report(const Fact& fact,
+                              std::shared_ptr<framework::Instruction> inst,
+                              framework::BugNotificationTiming timing,
+                              std::shared_ptr<framework::Function> function) {
+  State state = *fact.state;
+  if (!state.isBugState() || state.NotificationTiming() != timing || !inst)
+    return;
+
+  if (function &&
+      state.getTriggerConstraint() == TriggerConstraint::NON_RETURN &&
+      function->getReturnValue() && *fact.value == *function->getReturnValue())
+    return;
+
+  if (!flex_ && fact.value->isArbitaryArrayElement()) return;
+  if (query_ && !query_->matches(inst.get()) &&
+      !query_->isQueriedValue(fact.value))
+    return;
+  if (!reported_.insert({inst.get(), fact.value.get(), fact.state}).second)
+    return;
+
+  std::string text;
+  llvm::raw_string_ostream text_stream(text);
+  framework::generateError(text_stream, inst.get(),
+                           "--- [" + state.Name() + "] ---");
+  framework::generateError(text_stream, inst.get(), fact.value.get());
+  if (fact.logs) fact.logs->generateLog(text_stream);
+  log_.report({framework::reportKey(inst.get(), state.Name(), fact.value.get()),
+               text_stream.str()});
+}
+}  // namespace framework
@@ -0,0 +1,66 @@
+#include "frontend/TransitionTable.hpp"
+
+#include <algorithm>
+
+namespace framework {
+TransitionTable::TransitionTable(const std::set<State>& states,
+                                 std::vector<Transition>& transitions)
+    : transitions_list_(transitions) {
+  // The set is ordered, so the indices can be searched
+  for (auto& state : states) states_.push_back(&state);
+  if (states_.size() >= kNone) {
+    valid_ = false;
+    return;
+  }
+
+  next_.assign(states_.size(), kNone);
+  transitions_.assign(states_.size(), nullptr);
+  for (auto& transition : transitions) {
+    uint8_t source = Index(transition.Source());
+    uint8_t target = Index(transition.Target());
+    if (source == kNone || target == kNone) {
+      valid_ = false;
+      return;
+    }
+
+    if (!transitions_[source]) {
+      transitions_[source] = &transition;
+      next_[source] = target;
+    }
+    if (transition.Source().isInitState() &&
+        (!init_transition_ ||
+         transition.Target() < init_transition_->Target()))
+      init_transition_ = &transition;
+  }
+}
+
+uint8_t TransitionTable::Index(const State& state) const {
+  auto found = std::lower_bound(
+      states_.begin(), states_.end(), state,
+      [](const State* lhs, const State& rhs) { return *lhs < rhs; });
+  if (found == states_.end() || !(**found == state)) return kNone;
+  return found - states_.begin();
+}
+
+TransitionTable& TransitionTableCache::get(
+    const std::vector<Transition>& transitions) {
+  std::vector<std::pair<int, int>> key;
+  key.reserve(transitions.size());
+  for (auto& transition : transitions)
+    key.emplace_back(transition.Source().ID(), transition.Target().ID());
+
+  auto found = tables_.find(key);
+  if (found != tables_.end()) return *found->second.table;
+
+  // The map does not move its entries, so the table can refer to the list
+  Entry& entry = tables_[std::move(key)];
+  entry.transitions = transitions;
+  entry.table = std::make_unique<TransitionTable>(states_, entry.transitions);
+  return *entry.table;
+}
+
+void TransitionTable::apply(uint8_t* column, size_t size) const {
+  for (size_t i = 0; i < size; i++)
+    column[i] = column[i] < next_.size() ? next_[column[i]] : kNone;
+}
+}  // namespace framework
@@ -0,0 +1,62 @@
+#include "frontend/ValueLiveness.hpp"
+
+#include "llvm/IR/Instruction.h"
+
+namespace framework {
+ValueLiveness::ValueLiveness(std::shared_ptr<framework::Function> function)
+    : groups_(function) {
+  for (auto root : groups_.Roots()) {
+    auto group = groups_.find(root);
+    if (!group_index_.count(group))
+      group_index_.emplace(group, group_index_.size());
+  }
+
+  std::vector<std::shared_ptr<framework::Value>> returned = {
+      function->getReturnValue()};
+  for (auto& assignment : function->getReturnAssignments())
+    returned.push_back(assignment.second);
+  for (auto& value : returned) {
+    if (value && value->LLVMValue() && groups_.contains(value->LLVMValue()))
+      returned_groups_.insert(group_index_[groups_.find(value->LLVMValue())]);
+  }
+
+  auto& blocks = function->OrderedBasicBlocks();
+  std::vector<llvm::BitVector> uses(blocks.size(),
+                                    llvm::BitVector(group_index_.size()));
+  for (auto& block : blocks) {
+    for (auto& value : ValueGroups::UsedValues(block)) {
+      if (value && value->LLVMValue() && groups_.contains(value->LLVMValue()))
+        uses[block->Id()].set(group_index_[groups_.find(value->LLVMValue())]);
+    }
+  }
+
+  // Backwards until the loops settle
+  live_out_.assign(blocks.size(), llvm::BitVector(group_index_.size()));
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (auto block = blocks.rbegin(); block != blocks.rend(); block++) {
+      llvm::BitVector live_out(group_index_.size());
+      for (auto& successor : (*block)->Successors()) {
+        live_out |= uses[successor->Id()];
+        live_out |= live_out_[successor->Id()];
+      }
+      if (live_out == live_out_[(*block)->Id()]) continue;
+      live_out_[(*block)->Id()] = live_out;
+      changed = true;
+    }
+  }
+}
+
+// The values of unknown roots are kept, having no uses to go by
+bool ValueLiveness::isLiveOut(std::shared_ptr<framework::BasicBlock> block,
+                              const framework::Value& value) {
+  auto root = value.LLVMValue();
+  if (!root || !llvm::isa<llvm::Instruction>(root) ||
+      !groups_.contains(root) || block->Id() == BasicBlock::kNoId ||
+      static_cast<size_t>(block->Id()) >= live_out_.size())
+    return true;
+
+  auto group = group_index_[groups_.find(root)];
+  return returned_groups_.count(group) || live_out_[block->Id()][group];
+}
+}  // namespace framework
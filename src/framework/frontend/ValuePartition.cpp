@@ -0,0 +1,102 @@
+#include "frontend/ValuePartition.hpp"
+
+#include <algorithm>
+
+#include "core/Casting.hpp"
+#include "core/Instructions.hpp"
+
+namespace framework {
+ValueGroups::ValueGroups(std::shared_ptr<framework::Function> function) {
+  for (auto& block : function->OrderedBasicBlocks()) {
+    for (auto& value : UsedValues(block)) addRoot(value);
+    for (auto& inst : block->Instructions()) {
+      if (auto store_inst = shared_dyn_cast<framework::StoreInst>(inst)) {
+        unite(store_inst->PointerOperand()->LLVMValue(),
+              store_inst->ValueOperand()->LLVMValue());
+      } else if (auto call_inst = shared_dyn_cast<framework::CallInst>(inst)) {
+        // The callee may tie its arguments and what it returns together
+        addRoot(call_inst);
+        for (auto& argument : call_inst->Arguments())
+          unite(call_inst->LLVMValue(), argument->LLVMValue());
+      }
+    }
+  }
+}
+
+std::vector<std::shared_ptr<framework::Value>> ValueGroups::UsedValues(
+    std::shared_ptr<framework::BasicBlock> block) {
+  std::vector<std::shared_ptr<framework::Value>> values;
+  for (auto& inst : block->Instructions()) {
+    if (auto store_inst = shared_dyn_cast<framework::StoreInst>(inst)) {
+      values.push_back(store_inst->PointerOperand());
+      values.push_back(store_inst->ValueOperand());
+    } else if (auto load_inst = shared_dyn_cast<framework::LoadInst>(inst)) {
+      values.push_back(load_inst->LoadValue());
+    } else if (auto call_inst = shared_dyn_cast<framework::CallInst>(inst)) {
+      auto& arguments = call_inst->Arguments();
+      values.insert(values.end(), arguments.begin(), arguments.end());
+    }
+  }
+
+  auto branch_inst = block->getBranchInst();
+  if (!branch_inst || !branch_inst->Condition()) return values;
+  if (auto compare_inst = shared_dyn_cast<framework::CompareInst>(
+          branch_inst->Condition())) {
+    for (auto& operand : compare_inst->Operands()) values.push_back(operand);
+  }
+  return values;
+}
+
+ValuePartition::ValuePartition(std::shared_ptr<framework::Function> function,
+                               size_t parts) {
+  ValueGroups value_groups(function);
+
+  // Largest group first onto the least loaded part
+  std::map<const llvm::Value*, std::vector<const llvm::Value*>> groups;
+  std::vector<const llvm::Value*> group_order;
+  for (auto root : value_groups.Roots()) {
+    auto& group = groups[value_groups.find(root)];
+    if (group.empty()) group_order.push_back(value_groups.find(root));
+    group.push_back(root);
+  }
+  std::stable_sort(group_order.begin(), group_order.end(),
+                   [&groups](const llvm::Value* lhs, const llvm::Value* rhs) {
+                     return groups[lhs].size() > groups[rhs].size();
+                   });
+
+  std::vector<size_t> load(std::max<size_t>(parts, 1), 0);
+  for (auto group : group_order) {
+    size_t part = std::min_element(load.begin(), load.end()) - load.begin();
+    load[part] += groups[group].size();
+    for (auto root : groups[group]) part_[root] = part;
+  }
+  parts_ = std::count_if(load.begin(), load.end(),
+                         [](size_t size) { return size > 0; });
+}
+
+size_t ValuePartition::PartOf(const framework::Value& value) const {
+  auto part = part_.find(value.LLVMValue());
+  return part != part_.end() ? part->second : 0;
+}
+
+const llvm::Value* ValueGroups::find(const llvm::Value* root) {
+  auto parent = parent_.find(root);
+  if (parent == parent_.end() || parent->second == root) return root;
+  return parent->second = find(parent->second);
+}
+
+void ValueGroups::unite(const llvm::Value* lhs, const llvm::Value* rhs) {
+  if (!parent_.count(lhs) || !parent_.count(rhs)) return;
+  parent_[find(rhs)] = find(lhs);
+}
+
+// Constants carry no state
+void ValueGroups::addRoot(std::shared_ptr<framework::Value> value) {
+  if (!value || !value->LLVMValue() ||
+      shared_isa<framework::ConstValue>(value) ||
+      shared_isa<framework::NullValue>(value))
+    return;
+  if (parent_.emplace(value->LLVMValue(), value->LLVMValue()).second)
+    roots_.push_back(value->LLVMValue());
+}
+}  // namespace framework
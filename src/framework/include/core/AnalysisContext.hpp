@@ -0,0 +1,86 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+
+#include "core/Value.hpp"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
+
+namespace framework {
+class Converter;
+class Function;
+
+// Owns everything built while analyzing modules: the managed functions, the
+// converter with the managed values and the framework IR of each module. The
+// factories (Converter::GetInstance, Function::createManagedFunction, ...)
+// work on the context current on the calling thread, which is a process-wide
+// one unless a Scope says otherwise. Contexts on different threads share no
+// state, and destroying a context frees what was built in it.
+class AnalysisContext {
+ public:
+  using FunctionSet = std::set<std::shared_ptr<framework::Function>>;
+
+  AnalysisContext();
+  ~AnalysisContext();
+  AnalysisContext(const AnalysisContext&) = delete;
+  AnalysisContext& operator=(const AnalysisContext&) = delete;
+
+  // The context of the calling thread
+  static AnalysisContext& Current();
+
+  // Makes a context current on this thread for the lifetime of the scope
+  class Scope {
+   public:
+    explicit Scope(AnalysisContext& context);
+    ~Scope();
+
+   private:
+    AnalysisContext* previous_;
+  };
+
+  framework::Converter& getConverter() { return *converter_; }
+  std::map<llvm::Function*, std::shared_ptr<framework::Function>>&
+  CreatedFunctions() {
+    return created_functions_;
+  }
+  Value::AccessPathStats& PathStats() { return path_stats_; }
+
+  // The framework functions generated for a module
+  FunctionSet& FrameworkIR(const llvm::Module* module) {
+    return framework_ir_[module];
+  }
+  bool hasFrameworkIR(const llvm::Module* module) const {
+    return framework_ir_.count(module);
+  }
+  void releaseFrameworkIR(const llvm::Module* module) {
+    framework_ir_.erase(module);
+  }
+
+  // True the first time it is asked for a module, as the IR generator
+  // finalizes again when the analysis requires it, after the optimizations
+  bool addSnapshot(const llvm::Module* module) {
+    return snapshots_.emplace(module, std::string()).second;
+  }
+  // The snapshot of a module kept for the daemon
+  bool hasSnapshot(const llvm::Module* module) const {
+    auto snapshot = snapshots_.find(module);
+    return snapshot != snapshots_.end() && !snapshot->second.empty();
+  }
+  std::string& Snapshot(const llvm::Module* module) {
+    return snapshots_[module];
+  }
+
+  // Forget every value and function, e.g. between two modules
+  void clear();
+
+ private:
+  std::unique_ptr<framework::Converter> converter_;
+  std::map<llvm::Function*, std::shared_ptr<framework::Function>>
+      created_functions_;
+  std::map<const llvm::Module*, FunctionSet> framework_ir_;
+  std::map<const llvm::Module*, std::string> snapshots_;
+  Value::AccessPathStats path_stats_;
+};
+}  // namespace framework
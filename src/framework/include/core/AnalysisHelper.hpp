@@ -21,6 +21,7 @@ static long getMemberIndiceFromByte(llvm::Instruction *instruction,
 static const llvm::StructLayout *getStructLayout(llvm::Instruction *instruction,
                                                  llvm::StructType *STy);
 
+// True when target is within depth + 1 predecessor edges of block
 bool isInPredecessor(std::shared_ptr<framework::BasicBlock> target,
                      std::shared_ptr<framework::BasicBlock> block, int depth);
 }  // namespace framework
@@ -1,4 +1,7 @@
 #pragma once
+#include <cstdint>
+#include <iterator>
+#include <map>
 #include <memory>
 #include <set>
 #include <vector>
@@ -10,8 +13,69 @@ namespace framework {
 // TODO: remove this prototype from here
 class Function;
 class BranchInst;
+class BasicBlock;
+
+// The blocks of a run of ids in one of the CSR edge arrays of the function.
+// The blocks are handed out by reference, so walking the CFG neither copies
+// nor locks a pointer.
+class BlockRange {
+ public:
+  using Blocks = std::vector<std::shared_ptr<framework::BasicBlock>>;
+
+  class iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::shared_ptr<framework::BasicBlock>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+    iterator(const Blocks* blocks, const uint32_t* id)
+        : blocks_(blocks), id_(id) {}
+
+    reference operator*() const { return (*blocks_)[*id_]; }
+    pointer operator->() const { return &(*blocks_)[*id_]; }
+    iterator& operator++() {
+      ++id_;
+      return *this;
+    }
+    iterator operator++(int) { return iterator(blocks_, id_++); }
+    bool operator==(const iterator& other) const { return id_ == other.id_; }
+    bool operator!=(const iterator& other) const { return id_ != other.id_; }
+
+   private:
+    const Blocks* blocks_;
+    const uint32_t* id_;
+  };
+
+  BlockRange() = default;
+  BlockRange(const Blocks* blocks, const std::vector<uint32_t>* ids,
+             uint32_t begin, uint32_t end)
+      : blocks_(blocks), ids_(ids), begin_(begin), end_(end) {}
+
+  iterator begin() const { return iterator(blocks_, id(begin_)); }
+  iterator end() const { return iterator(blocks_, id(end_)); }
+  size_t size() const { return end_ - begin_; }
+  bool empty() const { return begin_ == end_; }
+
+ private:
+  const uint32_t* id(uint32_t index) const {
+    return ids_ ? ids_->data() + index : nullptr;
+  }
+
+  const Blocks* blocks_ = nullptr;
+  const std::vector<uint32_t>* ids_ = nullptr;
+  uint32_t begin_ = 0;
+  uint32_t end_ = 0;
+};
+
 class BasicBlock {
  public:
+  using PassthroughMap =
+      std::map<std::weak_ptr<framework::BasicBlock>,
+               std::vector<std::weak_ptr<framework::BasicBlock>>,
+               std::owner_less<>>;
+
   constexpr static long kNoId = -1;
   BasicBlock(llvm::BasicBlock* basic_block);
 
@@ -20,25 +84,19 @@ class BasicBlock {
 
   bool operator<(const framework::BasicBlock& basic_block);
 
-  friend bool operator<(
-      const std::weak_ptr<framework::BasicBlock> basic_block,
-      const std::weak_ptr<framework::BasicBlock> target_block);
-
   friend bool operator==(
       const std::shared_ptr<framework::BasicBlock> basic_block,
       const llvm::BasicBlock* llvm_block);
 
-  void addSuccessor(std::shared_ptr<framework::BasicBlock> block);
-  void addPredecessor(std::shared_ptr<framework::BasicBlock> block);
-  bool isInPredecessor(std::shared_ptr<framework::BasicBlock> block);
-
-  const std::set<std::weak_ptr<framework::BasicBlock>>& Predecessors() {
-    return predecessors_;
+  // Set by the function once all of its blocks are generated
+  void setEdges(BlockRange successors, BlockRange predecessors) {
+    successors_ = successors;
+    predecessors_ = predecessors;
   }
+  bool isInPredecessor(std::shared_ptr<framework::BasicBlock> block);
 
-  const std::set<std::weak_ptr<framework::BasicBlock>>& Successors() {
-    return successors_;
-  }
+  const BlockRange& Predecessors() { return predecessors_; }
+  const BlockRange& Successors() { return successors_; }
 
   void addInstruction(std::shared_ptr<framework::Instruction> inst);
   const std::vector<std::shared_ptr<framework::Instruction>> Instructions() {
@@ -54,6 +112,11 @@ class BasicBlock {
   bool collectPassthroughBlock();
   const std::vector<std::weak_ptr<framework::BasicBlock>> getPassthroughBlock(
       std::weak_ptr<framework::BasicBlock> succ_block);
+  const PassthroughMap& PassthroughBlocks() { return pass_through_; }
+  void addPassthroughBlock(std::shared_ptr<framework::BasicBlock> succ_block,
+                           std::shared_ptr<framework::BasicBlock> pred_block) {
+    pass_through_[succ_block].push_back(pred_block);
+  }
 
   void addDeadValue(std::shared_ptr<framework::Value> value);
   const std::set<std::shared_ptr<framework::Value>> DeadValues() const;
@@ -86,15 +149,13 @@ class BasicBlock {
 
   bool is_cleanup_block_;
 
-  std::map<std::weak_ptr<framework::BasicBlock>,
-           std::vector<std::weak_ptr<framework::BasicBlock>>, std::owner_less<>>
-      pass_through_;
+  PassthroughMap pass_through_;
 
   // Values to be dead by the end of this BB
   std::set<std::shared_ptr<framework::Value>> dead_values_;
 
   // Interactions
-  std::set<std::weak_ptr<framework::BasicBlock>> predecessors_;
-  std::set<std::weak_ptr<framework::BasicBlock>> successors_;
+  BlockRange predecessors_;
+  BlockRange successors_;
 };
 }  // namespace framework
@@ -5,7 +5,9 @@
 #include <vector>
 
 #include "core/BasicBlock.hpp"
+#include "core/Reachability.hpp"
 #include "core/Value.hpp"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Analysis/LoopInfo.h"
 #include "llvm/IR/Function.h"
 
@@ -46,9 +48,14 @@ class Function {
 
   std::shared_ptr<framework::BasicBlock> getBasicBlock(
       llvm::BasicBlock* basic_block);
+  // The block alone, without looking at its terminator or its edges, for the
+  // blocks loaded from a snapshot
+  std::shared_ptr<framework::BasicBlock> addBasicBlock(
+      llvm::BasicBlock* basic_block);
 
-  const std::set<std::shared_ptr<framework::BasicBlock>>& BasicBlocks() {
-    return basic_blocks_;
+  // The blocks by id, which is their order in the llvm function
+  const std::vector<std::shared_ptr<framework::BasicBlock>>& BasicBlocks() {
+    return blocks_;
   }
 
   const std::shared_ptr<framework::BasicBlock> InitBlock() {
@@ -65,6 +72,7 @@ class Function {
     return return_assignment_;
   };
 
+  llvm::Function* LLVMFunction() { return llvm_function_; }
   const llvm::Type* ReturnType() { return return_type_; }
   std::string Name() { return function_name_; };
   bool isDeclaration() { return is_definition_; };
@@ -79,18 +87,27 @@ class Function {
 
   uint64_t ArgSize() { return arg_size_; }
 
-  bool hasLoopInfo() { return loop_info_.get(); }
+  bool hasLoopInfo() { return loop_info_.get() || !loop_blocks_.empty(); }
   bool isLoopBlock(std::shared_ptr<framework::BasicBlock>);
 
   void setLoopInfo(std::unique_ptr<llvm::LoopInfo> loop_info) {
     loop_info_ = std::move(loop_info);
   }
+  // Whether each block id is in a loop, when there is no loop info to ask
+  // (e.g. for a function loaded from a snapshot)
+  void setLoopBlocks(std::vector<bool> loop_blocks) {
+    loop_blocks_ = std::move(loop_blocks);
+  }
 
   std::shared_ptr<framework::BasicBlock> ReturnBlock() { return return_block_; }
-  static std::map<llvm::Function*, std::shared_ptr<framework::Function>>
-  CreatedFunctions() {
-    return created_functions_;
-  }
+  // The functions of the current AnalysisContext
+  static std::map<llvm::Function*, std::shared_ptr<framework::Function>>&
+  CreatedFunctions();
+  static void clearManagedFunctions();
+
+  // Drop the blocks and the other functions, which may refer back to this
+  // one, so that the functions of a context can be freed
+  void dropReferences();
 
   void addCallerFunction(std::shared_ptr<framework::Function> caller);
   const std::set<std::shared_ptr<framework::Function>>& CallerFunctions();
@@ -111,20 +128,23 @@ class Function {
   void setLoopBackBlock(bool loop_back);
   bool ContainsLoopBackBlock();
 
-  void addOrderedBlock(
-      std::vector<std::shared_ptr<framework::BasicBlock>>& block) {
-    ordered_basic_blocks_ = block;
-  }
+  // Lays out the edges of the generated blocks as CSR arrays and hands each
+  // block its ranges. Called once all of the blocks are generated.
+  void buildCFG();
+  // Replace the edges found so far by (block id, block id) pairs, e.g. the
+  // ones of a snapshot, to be laid out by buildCFG
+  void setEdges(std::vector<std::pair<uint32_t, uint32_t>> successor_edges,
+                std::vector<std::pair<uint32_t, uint32_t>> predecessor_edges);
 
   const std::vector<std::shared_ptr<framework::BasicBlock>>&
   OrderedBasicBlocks() {
-    return ordered_basic_blocks_;
+    return blocks_;
   }
 
- private:
-  static std::map<llvm::Function*, std::shared_ptr<framework::Function>>
-      created_functions_;
+  // Which blocks come before which, over the predecessors of buildCFG
+  framework::Reachability& BlockReachability();
 
+ private:
   // Function metas these should be updated to copy llvm::Function, but for the
   // time being, we manually copy everything
   llvm::Function* llvm_function_;
@@ -132,6 +152,7 @@ class Function {
   const llvm::Type* return_type_;
 
   std::unique_ptr<llvm::LoopInfo> loop_info_;
+  std::vector<bool> loop_blocks_;
   std::string function_name_;
   bool is_definition_;
   uint64_t arg_size_;
@@ -143,10 +164,29 @@ class Function {
   PossibleReturnAssignmentMap return_assignment_;
 
   std::set<std::shared_ptr<framework::Function>> caller_functions_;
-  std::set<std::shared_ptr<framework::BasicBlock>> basic_blocks_;
 
-  // TODO: Update to ordered basic block after it is proven worthy
-  std::vector<std::shared_ptr<framework::BasicBlock>> ordered_basic_blocks_;
+  // The blocks by id, and the ids of the llvm blocks
+  std::vector<std::shared_ptr<framework::BasicBlock>> blocks_;
+  llvm::DenseMap<llvm::BasicBlock*, uint32_t> block_ids_;
+
+  // The edges found while generating the blocks. The predecessors leave out
+  // the loop back edges, so they are not the reverse of the successors.
+  std::vector<std::pair<uint32_t, uint32_t>> successor_edges_;
+  std::vector<std::pair<uint32_t, uint32_t>> predecessor_edges_;
+
+  // The successors of block id are successor_ids_[successor_offsets_[id]]
+  // up to successor_ids_[successor_offsets_[id + 1]], and the same for the
+  // predecessors
+  std::vector<uint32_t> successor_offsets_;
+  std::vector<uint32_t> successor_ids_;
+  std::vector<uint32_t> predecessor_offsets_;
+  std::vector<uint32_t> predecessor_ids_;
+
+  std::unique_ptr<framework::Reachability> reachability_;
+
+  uint32_t blockId(llvm::BasicBlock* basic_block);
+  std::shared_ptr<framework::BasicBlock> createBasicBlock(
+      llvm::BasicBlock* basic_block, uint32_t id);
 
   std::shared_ptr<framework::BasicBlock> init_block_;
   std::shared_ptr<framework::BasicBlock> return_block_;
@@ -1,4 +1,6 @@
 #pragma once
+#include <cstdint>
+
 #include "core/Casting.hpp"
 #include "core/Value.hpp"
 #include "llvm/IR/InstrTypes.h"
@@ -11,6 +13,8 @@ namespace framework {
 class BasicBlock;
 class Instruction : public Value {
  public:
+  static constexpr uint32_t kNoSequence = UINT32_MAX;
+
   static std::shared_ptr<Instruction> Create(std::shared_ptr<Instruction> inst,
                                              std::vector<Fields> field,
                                              long array_element_num);
@@ -25,6 +29,8 @@ class Instruction : public Value {
   Instruction(std::shared_ptr<Instruction> instruction,
               std::vector<Fields> fields, long array_element_num);
 
+  // Instructions of the same function are ordered by their sequence numbers,
+  // the others by module, line and opcode
   bool operator<=(const framework::Instruction& instruction) const;
 
   bool operator<(llvm::Instruction* instruction) const;
@@ -47,6 +53,16 @@ class Instruction : public Value {
   const llvm::Module* Module() const { return module_; }
   const std::weak_ptr<framework::BasicBlock> Parent() const { return parent_; }
 
+  // The position of the instruction in its function, set by the IR generator
+  // over the blocks in reverse post order. The function is kept as well since
+  // the llvm instruction may be gone by the time the analysis runs.
+  void setSequence(const llvm::Function* function, uint32_t sequence) {
+    sequence_function_ = function;
+    sequence_ = sequence;
+  }
+  uint32_t Sequence() const { return sequence_; }
+  const llvm::Function* SequenceFunction() const { return sequence_function_; }
+
   const llvm::DebugLoc& getDebugLoc() { return debug_loc_; };
   llvm::Instruction* LLVMInstruction() { return llvm_instruction_; };
 
@@ -65,5 +81,7 @@ class Instruction : public Value {
   unsigned int opcode_;
   unsigned int column_;
   unsigned int line_;
+  const llvm::Function* sequence_function_ = nullptr;
+  uint32_t sequence_ = kNoSequence;
 };
 }  // namespace framework
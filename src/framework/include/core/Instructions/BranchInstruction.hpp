@@ -26,7 +26,15 @@ class CompareInst : public Instruction {
     return operands_;
   }
 
+  // The operands replaced by the values stored into them
+  const std::vector<std::shared_ptr<framework::Value>>& Replaced() const {
+    return replaced_;
+  }
+
   void setOperands(std::vector<std::shared_ptr<framework::Value>> operand);
+  void setReplaced(std::vector<std::shared_ptr<framework::Value>> replaced) {
+    replaced_ = replaced;
+  }
   void replaceOperand(std::shared_ptr<framework::Value> operand,
                       std::shared_ptr<framework::Value> new_operand);
   bool operandExists(std::shared_ptr<framework::Value> value);
@@ -54,6 +62,32 @@ class CompareInst : public Instruction {
   std::vector<std::shared_ptr<framework::Value>> replaced_;
 };
 
+// What the branch ending a block tells about the values, computed once when
+// the framework IR is generated
+struct BranchFacts {
+  // The calls whose returned value is checked: the condition itself or the
+  // operands of the compare
+  std::vector<std::shared_ptr<framework::CallInst>> calls;
+  llvm::CmpInst::Predicate predicate = llvm::CmpInst::ICMP_NE;
+  bool null_operand = false;
+  int64_t compared_constant = 0;
+  // The last operand of the compare that is neither null nor a constant
+  std::shared_ptr<framework::Value> compared_value;
+  // The condition checks a returned value, so the paths out of the block are
+  // error paths. Set once the whole module is generated, as the returned
+  // values of the called functions are marked along the way.
+  bool error_path = false;
+};
+
+// What a CFG edge out of a branch tells about the compared value
+struct EdgeFacts {
+  enum Refinement { NONE, NULL_PATH, NON_NULL_PATH };
+
+  bool true_path = false;
+  bool false_path = false;
+  Refinement refinement = NONE;
+};
+
 class BranchInst : public Instruction {
  public:
   using TransitionNodes = std::vector<std::weak_ptr<framework::BasicBlock>>;
@@ -88,9 +122,18 @@ class BranchInst : public Instruction {
 
   bool isInOperand(std::shared_ptr<framework::Value> value);
   bool returnValueOperandExists();
+  const std::map<int64_t, TransitionNodes>& Nodes() const { return nodes_; }
   TransitionNodes TruePathNodes() { return nodes_[kTrueTransition]; };
   TransitionNodes FalsePathNodes() { return nodes_[kFalseTransition]; };
 
+  const BranchFacts& Facts() const { return facts_; }
+  void setFacts(const BranchFacts& facts) { facts_ = facts; }
+  // nullptr when the block is not a successor
+  const EdgeFacts* getEdgeFacts(
+      const std::shared_ptr<framework::BasicBlock>& successor) const;
+  void setEdgeFacts(std::shared_ptr<framework::BasicBlock> successor,
+                    const EdgeFacts& facts);
+
   /// Methods for support type inquiry through isa, cast, and dyn_cast:
   static bool classof(const framework::Instruction* I) {
     return I->Opcode() == llvm::Instruction::Br ||
@@ -105,5 +148,8 @@ class BranchInst : public Instruction {
  private:
   std::shared_ptr<framework::Instruction> condition_instruction_;
   std::map<int64_t, TransitionNodes> nodes_;
+
+  BranchFacts facts_;
+  std::map<framework::BasicBlock*, EdgeFacts> edge_facts_;
 };
 }  // namespace framework
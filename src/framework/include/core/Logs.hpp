@@ -1,10 +1,12 @@
 #pragma once
+#include <functional>
 #include <iostream>
 #include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/raw_ostream.h"
 
 namespace framework {
@@ -50,13 +52,36 @@ struct EndPoints {
 
 class LoggingClient {
  public:
+  // A bug report. The reports of several analyses are merged on the key, see
+  // reportKey.
+  struct Report {
+    std::string key;
+    std::string text;
+  };
+  using ReportCallback = std::function<void(const Report& report)>;
+
   LoggingClient();
+  // Collect the flushed logs into the sink instead of a pipe, for analyzers
+  // running in the process that reads them
+  explicit LoggingClient(std::string& sink);
 
   void log(const std::string& log);
+  // Log the report, unless a callback takes the reports
+  void report(const Report& report);
+  void setReportCallback(ReportCallback callback) {
+    report_callback_ = callback;
+  }
   void flush();
+  // Hand the buffered logs over instead of flushing them
+  std::string takeBuffer();
 
   void printLog();
 
+  // Reports as bytes to send over a pipe, and back. A report without a key
+  // carries plain logs.
+  static std::string encodeReport(const Report& report);
+  static std::vector<Report> decodeReports(llvm::StringRef records);
+
   LoggingClient& operator<<(const std::string& log);
   friend llvm::raw_ostream& operator<<(llvm::raw_ostream& ostream,
                                        framework::LoggingClient& client);
@@ -67,7 +92,9 @@ class LoggingClient {
 
  private:
   std::string buffer_;
+  std::string* sink_ = nullptr;
   struct EndPoints end_points_;
+  ReportCallback report_callback_;
 };
 
 class LoggingServer {
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "core/BasicBlock.hpp"
+
+namespace framework {
+// How far back a block is from another along the predecessor edges of a
+// function. The distances from a block to all of its ancestors are found
+// with one breadth-first walk over the CSR predecessor arrays the first time
+// the block is asked about, and kept as two bytes per block, so every later
+// query on that block is a lookup. Only the blocks asked about pay for their
+// row, which keeps large functions cheap.
+class Reachability {
+ public:
+  static constexpr uint16_t kUnreachable = UINT16_MAX;
+  // The ancestors farther away than this are all kept at this distance
+  static constexpr uint16_t kFarthest = UINT16_MAX - 1;
+
+  Reachability(const std::vector<uint32_t>& predecessor_offsets,
+               const std::vector<uint32_t>& predecessor_ids);
+
+  // The fewest predecessor edges walked from block to reach target, which
+  // is at least one even when target is block
+  uint16_t Distance(uint32_t target, uint32_t block);
+
+  // True when target is reached from block within steps predecessor edges
+  bool isPredecessor(uint32_t target, uint32_t block, unsigned steps) {
+    return Distance(target, block) <= steps;
+  }
+  bool isPredecessor(std::shared_ptr<framework::BasicBlock> target,
+                     std::shared_ptr<framework::BasicBlock> block,
+                     unsigned steps);
+
+  // True when target is reached from block at all
+  bool isAncestor(uint32_t target, uint32_t block) {
+    return Distance(target, block) != kUnreachable;
+  }
+  bool isAncestor(std::shared_ptr<framework::BasicBlock> target,
+                  std::shared_ptr<framework::BasicBlock> block) {
+    return isPredecessor(target, block, kFarthest);
+  }
+
+ private:
+  const std::vector<uint16_t>& Row(uint32_t block);
+
+  const std::vector<uint32_t>& offsets_;
+  const std::vector<uint32_t>& ids_;
+  std::vector<std::vector<uint16_t>> rows_;
+};
+}  // namespace framework
@@ -10,6 +10,7 @@
 #include "llvm/IR/Value.h"
 
 namespace framework {
+class AnalysisContext;
 
 class Converter {
  public:
@@ -19,7 +20,7 @@ class Converter {
     std::vector<framework::Value::Fields> fields;
   };
 
-  // factory
+  // The converter of the current AnalysisContext
   static Converter& GetInstance();
 
   struct ValueSignature GetSignitureFromDefinition(llvm::Value* value);
@@ -106,7 +107,16 @@ class Converter {
           std::vector<framework::Value::Fields>());
   std::shared_ptr<framework::Value> getManagedValue(ValueSignature signature);
 
+  const std::map<llvm::Value*, std::vector<std::shared_ptr<framework::Value>>>&
+  ManagedValues() const {
+    return managed_values_;
+  }
+
+  void clear() { managed_values_.clear(); }
+  size_t Size() { return managed_values_.size(); }
+
  private:
+  friend class AnalysisContext;
   Converter() = default;
 
   std::map<llvm::Value*, std::vector<std::shared_ptr<framework::Value>>>
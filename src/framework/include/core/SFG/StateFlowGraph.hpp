@@ -0,0 +1,52 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "core/BasicBlock.hpp"
+#include "core/Function.hpp"
+
+namespace framework {
+// Sparse view of the CFG for the state analysis. Its nodes are the blocks
+// that can change a state (calls, stores, loads if used, null or return
+// value checks on the way in, dead values), the entry and the return blocks,
+// and the blocks a pass-through block selects from. Its edges skip the other
+// blocks, which pass the states through unchanged, so the analysis neither
+// visits them nor copies the states into them.
+class StateFlowGraph {
+ public:
+  // A node the states come from, and the successor they leave it through
+  struct Edge {
+    std::shared_ptr<framework::BasicBlock> source;
+    std::shared_ptr<framework::BasicBlock> successor;
+  };
+
+  StateFlowGraph(std::shared_ptr<framework::Function> function,
+                 bool track_loads);
+
+  // In the order of Function::OrderedBasicBlocks
+  const std::vector<std::shared_ptr<framework::BasicBlock>>& Nodes() {
+    return nodes_;
+  }
+  bool isNode(std::shared_ptr<framework::BasicBlock> block) {
+    return node_set_.find(block) != node_set_.end();
+  }
+
+  const std::vector<Edge>& Predecessors(
+      std::shared_ptr<framework::BasicBlock> block) {
+    return predecessors_[block];
+  }
+
+ private:
+  bool changesStates(std::shared_ptr<framework::BasicBlock> block,
+                     bool track_loads);
+  bool branchChangesStates(std::shared_ptr<framework::BasicBlock> block);
+  void collectPredecessors(std::shared_ptr<framework::BasicBlock> node);
+
+  std::vector<std::shared_ptr<framework::BasicBlock>> nodes_;
+  std::set<std::shared_ptr<framework::BasicBlock>> node_set_;
+  std::map<std::shared_ptr<framework::BasicBlock>, std::vector<Edge>>
+      predecessors_;
+};
+}  // namespace framework
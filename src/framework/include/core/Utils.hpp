@@ -64,6 +64,9 @@ void generateError(llvm::raw_ostream& stream, framework::Instruction* Inst,
 void generateError(llvm::raw_ostream& stream, framework::Instruction* Inst,
                    framework::Value* value);
 std::string getDebugInfo(framework::Instruction* inst);
+// What a bug report is deduplicated on: its location, bug and value
+std::string reportKey(framework::Instruction* inst, const std::string& bug,
+                      framework::Value* value);
 
 void generateLog(llvm::raw_ostream& stream, framework::Instruction* Inst,
                  std::string warn);
@@ -15,6 +15,9 @@ class Value {
   constexpr static int kNonFieldVariable = -1;
   constexpr static int kNonArrayElement = -2;
   constexpr static int kArbitaryArrayElement = -1;
+  // The field of a path cut at the access path depth, standing for any field
+  // below it
+  constexpr static int kSummarizedFields = -3;
 
   struct Fields {
     Fields(llvm::Type* type, long field = kNonFieldVariable)
@@ -35,7 +38,7 @@ class Value {
 
     llvm::Type* FieldType() const {
       llvm::Type* element = ElementType();
-      if (field == kNonFieldVariable || !element->isStructTy() ||
+      if (field < 0 || !element->isStructTy() ||
           element->getStructNumElements() < field)
         return nullptr;
       return element->getStructElementType(field);
@@ -43,6 +46,17 @@ class Value {
   };
   using FieldList = std::vector<Fields>;
 
+  struct AccessPathStats {
+    uint64_t paths = 0;
+    uint64_t truncated = 0;
+  };
+
+  // Cuts the paths deeper than -fitx-access-path-depth, the fields below the
+  // depth are summarized by one kSummarizedFields entry. True when cut.
+  static bool LimitFields(FieldList& fields);
+  static const AccessPathStats& PathStats();
+  static unsigned AccessPathDepth();
+
   // factory
   static std::shared_ptr<Value> CreateFromDefinition(llvm::Value* value);
   static std::shared_ptr<Value> CreateAppend(std::shared_ptr<Value> src,
@@ -68,6 +82,7 @@ class Value {
         array_element_num_(kNonArrayElement),
         fields_(std::vector<Fields>()),
         is_global_var_(llvm::isa<llvm::GlobalValue>(value)),
+        is_return_value_(false),
         value_type_(value->getValueID()){};
 
   Value(std::shared_ptr<Value> value);
@@ -79,6 +94,7 @@ class Value {
                                        const framework::Value& value);
 
   llvm::Value& getLLVMValue_() const;
+  const llvm::Value* LLVMValue() const { return value_; }
   llvm::Type& getLLVMType_() const;
 
   bool isArgument();
@@ -108,12 +124,7 @@ class Value {
 
   std::vector<std::weak_ptr<framework::Value>> Users() { return users_; }
 
-  void setManagedId(size_t id) { managed_id_ = id; }
-  size_t ManagedId() { return managed_id_; }
-
  private:
-  size_t managed_id_;
-
   llvm::Value* value_;
 
   unsigned value_type_;
@@ -234,24 +245,4 @@ class AliasValues {
   size_t alias_size_;
 };
 
-// A singleton class which keeps track of managed values
-class ManagedValues {
- public:
-  static ManagedValues GetInstance();
-  constexpr static size_t kReserveSize = 10000;
-
-  size_t Size() { return managed_values_.size(); }
-
-  void addValue(std::shared_ptr<framework::Value> value) {
-    value->setManagedId(Size());
-    return managed_values_.push_back(value);
-  }
-
-  std::shared_ptr<framework::Value> getValueFromID(size_t id);
-
- private:
-  ManagedValues();
-  std::vector<std::shared_ptr<framework::Value>> managed_values_;
-};
-
 };  // namespace framework
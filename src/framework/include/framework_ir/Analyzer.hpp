@@ -21,6 +21,9 @@ class Analyzer {
   void analyzeReturnInst(llvm::Instruction* return_inst);
   void analyzeStoreInst(llvm::Instruction* store_inst);
   void analyzeLoadInst(llvm::Instruction* load_inst);
+  // Once the blocks are complete, as stores may replace compared operands
+  void analyzeBranchInst(std::shared_ptr<framework::BasicBlock> block);
+  void numberInstructions(llvm::Function& function);
 
   std::shared_ptr<framework::Function> FrameworkFunction() {
     return framework_function_;
@@ -1,4 +1,5 @@
 #pragma once
+#include "core/AnalysisContext.hpp"
 #include "framework_ir/Analyzer.hpp"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/LegacyPassManager.h"
@@ -13,10 +14,27 @@ class IRGenerator : public llvm::FunctionPass {
 
   virtual void getAnalysisUsage(llvm::AnalysisUsage &AU) const override;
   bool runOnFunction(llvm::Function &F) override;
+  bool doFinalization(llvm::Module &M) override;
+
+  // Build the framework IR for every defined function of the module outside
+  // of the clang pipeline (e.g. for modules loaded from bitcode), in the
+  // given context
+  static void generate(llvm::Module &M,
+                       framework::AnalysisContext &context =
+                           framework::AnalysisContext::Current());
+
+  // Keep the snapshot of each module in the current context as the framework
+  // IR is generated from it, for the analysis to hand it over to fitxd
+  static void keepSnapshots();
+
+  // The framework IR of the module, as the pass generates it in the current
+  // context
+  static framework::AnalysisContext::FunctionSet &FrameworkIR(
+      const llvm::Module &M) {
+    return framework::AnalysisContext::Current().FrameworkIR(&M);
+  }
 
   static char ID;
-  static std::map<llvm::Module*, std::set<std::shared_ptr<framework::Function>>>
-      framework_ir_;
 
  private:
   Analyzer analyzer;
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "core/Function.hpp"
+
+namespace ir_generator {
+// Functions analyzed together by one worker in whole-program mode. Callees
+// outside of the shard are still analyzed on demand by the worker, so a
+// shard only decides where the analysis of its functions starts.
+struct Shard {
+  std::vector<std::shared_ptr<framework::Function>> functions;
+  uint64_t cost = 0;
+};
+
+// Partition the call graph of the functions into at most shard_count shards
+// of similar cost. Weakly connected components are kept whole when they fit
+// in a shard, so that no callee has to be analyzed twice. Larger components
+// are split by their entry functions (the ones without callers). Their
+// shared callees are then analyzed once per shard, so an entry costs as
+// much as all the functions it reaches.
+std::vector<Shard> partitionCallGraph(
+    const std::set<std::shared_ptr<framework::Function>>& functions,
+    size_t shard_count);
+}  // namespace ir_generator
@@ -0,0 +1,277 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/AnalysisContext.hpp"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace ir_generator {
+namespace snapshot {
+// On-disk snapshot of a module as the framework IR was generated from it,
+// i.e. before any optimization, for an offline re-analysis. It holds the
+// module bitcode and the framework IR as fixed size records, which refer to
+// the llvm values and types by their index in a walk of the module (see
+// ModuleIndex), and to each other by their index in their section. Loading
+// parses the bitcode and rebuilds the framework IR from the records, without
+// running the IR generator.
+constexpr uint32_t kMagic = 0x52495846;  // "FXIR"
+constexpr uint32_t kVersion = 3;
+
+// No value, block, type, ... in a reference
+constexpr uint32_t kNone = UINT32_MAX;
+
+struct Section {
+  uint64_t offset;
+  uint64_t size;
+};
+
+// A run of records in another section
+struct Range {
+  uint32_t begin;
+  uint32_t size;
+};
+
+// The framework class of a value, as the llvm value id does not tell e.g. a
+// StoreInst from the Instruction of the same llvm store
+enum ValueKind : uint32_t {
+  VALUE,
+  CONST_VALUE,
+  NULL_VALUE,
+  ARGUMENT,
+  INSTRUCTION,
+  CALL,
+  STORE,
+  LOAD,
+  COMPARE,
+  BRANCH,
+};
+
+enum ValueFlags : uint32_t {
+  RETURN_VALUE = 1 << 0,
+  // Found through the converter when the analysis creates the same value
+  MANAGED = 1 << 1,
+};
+
+// operands: the arguments of a call, the value and the pointer of a store,
+// the loaded value or the operands of a compare, as value indices.
+// extra: the replaced operands of a compare or the BranchRecord of a branch.
+struct ValueRecord {
+  uint32_t kind;
+  uint32_t value;
+  uint32_t value_id;
+  uint32_t flags;
+  int64_t array_element_num;
+  Range fields;
+  Range operands;
+  Range extra;
+  uint32_t sequence;
+  uint32_t sequence_function;
+};
+
+struct FieldRecord {
+  uint32_t type;
+  uint32_t reserved;
+  int64_t field;
+};
+
+struct PairRecord {
+  uint32_t first;
+  uint32_t second;
+};
+
+struct NodeRecord {
+  int64_t code;
+  uint32_t block;
+  uint32_t reserved;
+};
+
+enum BranchFlags : uint32_t {
+  NULL_OPERAND = 1 << 0,
+  ERROR_PATH = 1 << 1,
+};
+
+// nodes: the transition nodes of each code. edges: the successor and the
+// EdgeFacts packed as true path, false path and the refinement above them.
+struct BranchRecord {
+  uint32_t condition;
+  uint32_t predicate;
+  uint32_t compared_value;
+  uint32_t flags;
+  int64_t compared_constant;
+  Range calls;
+  Range nodes;
+  Range edges;
+};
+
+enum BlockFlags : uint32_t { LOOP_BLOCK = 1 << 0 };
+
+// pass_through: the successor and the predecessor of each pass-through pair
+struct BlockRecord {
+  uint32_t block;
+  uint32_t flags;
+  uint32_t branch;
+  uint32_t reserved;
+  Range instructions;
+  Range dead_values;
+  Range pass_through;
+};
+
+enum FunctionFlags : uint32_t {
+  // Generated from the module, rather than only called by it
+  FRAMEWORK_IR = 1 << 0,
+  LOOP_BACK = 1 << 1,
+  LOOP_INFO = 1 << 2,
+};
+
+// blocks: one record per block id. successors and predecessors: the edges
+// as block ids. return_assignments: the block and the value.
+struct FunctionRecord {
+  uint32_t function;
+  uint32_t flags;
+  uint32_t return_value;
+  uint32_t return_block;
+  uint32_t protected_refcount_value;
+  uint32_t last_refcount_call;
+  Range blocks;
+  Range successors;
+  Range predecessors;
+  Range return_assignments;
+  Range callers;
+};
+
+// value_count and type_count are the size of the module index the records
+// were written against, which a loaded module must match
+struct Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t value_count;
+  uint32_t type_count;
+  Section bitcode;
+  Section values;
+  Section fields;
+  Section refs;
+  Section pairs;
+  Section nodes;
+  Section branches;
+  Section blocks;
+  Section functions;
+};
+
+// The values and the types of a module in a fixed order: the globals, the
+// functions, the aliases and the ifuncs, the arguments, blocks and
+// instructions of each function, then the constants and the other operands
+// as they are first used. The order only depends on the module, so a module
+// parsed from the bitcode has the same index as the one it was written from.
+class ModuleIndex {
+ public:
+  explicit ModuleIndex(llvm::Module& M);
+
+  uint32_t valueIndex(const llvm::Value* value) const;
+  uint32_t typeIndex(llvm::Type* type) const;
+
+  llvm::Value* value(uint32_t index) const {
+    return index < values_.size() ? values_[index] : nullptr;
+  }
+  llvm::Type* type(uint32_t index) const {
+    return index < types_.size() ? types_[index] : nullptr;
+  }
+
+  size_t valueCount() const { return values_.size(); }
+  size_t typeCount() const { return types_.size(); }
+
+ private:
+  void addValue(llvm::Value* value);
+  void addOperands(llvm::User* user);
+  void addType(llvm::Type* type);
+
+  std::vector<llvm::Value*> values_;
+  llvm::DenseMap<const llvm::Value*, uint32_t> value_indices_;
+  std::vector<llvm::Type*> types_;
+  llvm::DenseMap<llvm::Type*, uint32_t> type_indices_;
+};
+
+class SnapshotWriter {
+ public:
+  SnapshotWriter() = default;
+
+  void addModule(llvm::Module& M);
+  // The framework IR generated from the module in the context. False if a
+  // value cannot be referenced, in which case only the bitcode is written
+  // and loading generates the framework IR again.
+  bool addFrameworkIR(llvm::Module& M, framework::AnalysisContext& context);
+
+  void write(llvm::raw_ostream& stream);
+  // False, once the reason is logged, if the file could not be written
+  bool writeToFile(const std::string& path);
+
+ private:
+  class Recorder;
+
+  void clearRecords();
+
+  llvm::SmallVector<char, 0> bitcode_;
+
+  uint32_t value_count_ = 0;
+  uint32_t type_count_ = 0;
+  std::vector<ValueRecord> values_;
+  std::vector<FieldRecord> fields_;
+  std::vector<uint32_t> refs_;
+  std::vector<PairRecord> pairs_;
+  std::vector<NodeRecord> nodes_;
+  std::vector<BranchRecord> branches_;
+  std::vector<BlockRecord> blocks_;
+  std::vector<FunctionRecord> functions_;
+};
+
+class SnapshotReader {
+ public:
+  // Map the snapshot file. Returns nullptr if it is not a valid snapshot.
+  static std::unique_ptr<SnapshotReader> open(const std::string& path);
+  // Same, for a snapshot already in memory, e.g. received by fitxd
+  static std::unique_ptr<SnapshotReader> open(
+      std::unique_ptr<llvm::MemoryBuffer> buffer);
+
+  bool hasBitcode() const { return !bitcode_.empty(); }
+  bool hasFrameworkIR() const { return !functions_.empty(); }
+
+  // Parse the bitcode
+  std::unique_ptr<llvm::Module> loadModule(llvm::LLVMContext& context) const;
+
+  // Rebuild the framework IR of the module parsed by loadModule from the
+  // records, in the given context. False, with the context cleared, if there
+  // are no records or they do not match the module, for the caller to run
+  // IRGenerator::generate instead.
+  bool loadFrameworkIR(llvm::Module& M,
+                       framework::AnalysisContext& context) const;
+
+ private:
+  class Loader;
+
+  SnapshotReader() = default;
+  bool map(std::unique_ptr<llvm::MemoryBuffer> buffer);
+  template <class Record>
+  bool mapSection(const Section& section, llvm::ArrayRef<Record>& records);
+
+  std::unique_ptr<llvm::MemoryBuffer> buffer_;
+  Header header_;
+  llvm::StringRef bitcode_;
+  llvm::ArrayRef<ValueRecord> values_;
+  llvm::ArrayRef<FieldRecord> fields_;
+  llvm::ArrayRef<uint32_t> refs_;
+  llvm::ArrayRef<PairRecord> pairs_;
+  llvm::ArrayRef<NodeRecord> nodes_;
+  llvm::ArrayRef<BranchRecord> branches_;
+  llvm::ArrayRef<BlockRecord> blocks_;
+  llvm::ArrayRef<FunctionRecord> functions_;
+};
+}  // namespace snapshot
+}  // namespace ir_generator
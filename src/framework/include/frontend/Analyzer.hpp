@@ -25,7 +25,9 @@
 
 // include STL
 #include <algorithm>
+#include <chrono>
 #include <ctime>
+#include <functional>
 #include <iostream>
 #include <iterator>
 #include <map>
@@ -37,23 +39,39 @@
 #include <vector>
 
 #include "BasicBlock.hpp"
+#include "CandidateScan.hpp"
 #include "Function.hpp"
 #include "Logs.hpp"
 #include "State.hpp"
+#include "ValuePartition.hpp"
 #include "StateTransition.hpp"
 #include "Utils.hpp"
 
 // Type Alias Analysis
+#include "core/AnalysisContext.hpp"
 #include "core/Instructions.hpp"
 #include "core/ValueTypeAlias.hpp"
 
 namespace framework {
 class Analyzer {
  public:
+  using ProgressCallback =
+      std::function<void(std::shared_ptr<framework::Function>)>;
+  // Whether the function is worth starting an analysis from
+  using CandidateFilter =
+      std::function<bool(std::shared_ptr<framework::Function>)>;
+
+  // The module's framework IR is looked up in the context, and whatever the
+  // analysis creates is kept there
   Analyzer(llvm::Module& llvm_module, framework::StateManager& state_manager,
-           framework::LoggingClient& client);
+           framework::LoggingClient& client,
+           framework::AnalysisContext& context =
+               framework::AnalysisContext::Current());
 
   void analyze();
+  // Only start from the given functions, e.g. a shard of a whole program
+  void analyze(
+      const std::vector<std::shared_ptr<framework::Function>>& functions);
 
   /* Analyzer for each framework instruction */
   void analyzeFunction(std::shared_ptr<framework::Function> F);
@@ -68,6 +86,11 @@ class Analyzer {
   void changeValueState(std::vector<Transition> transitions,
                         std::shared_ptr<framework::Value> value,
                         std::shared_ptr<framework::Instruction> inst);
+  // changeValueState on each of the values, with the transitions compiled
+  // into a table once
+  void changeValueStates(std::vector<Transition> transitions,
+                         const std::set<std::shared_ptr<Value>>& values,
+                         std::shared_ptr<framework::Instruction> inst);
 
   void generateError(BugNotificationTiming timing,
                      const std::set<std::shared_ptr<framework::Value>> values =
@@ -90,10 +113,51 @@ class Analyzer {
 
   void checkAlias(std::shared_ptr<framework::StoreInst> store_inst);
 
+  // Drop the states of the arguments of a call whose callee is unknown
+  void escapeArguments(std::shared_ptr<framework::CallInst> call_inst);
+
+  bool overBudget(std::shared_ptr<FunctionInformation> func_info);
+  // Report the function again if it has been analyzed for a while
+  void reportProgress(std::shared_ptr<framework::Function> function);
+
+  // Functions called by the analyzed ones are still analyzed on their call
+  bool skipFunction(std::shared_ptr<framework::Function> function);
+
+  // Split the values of a huge entry function over forked workers. False
+  // when the function is not worth it.
+  bool analyzePartitioned(std::shared_ptr<framework::Function> function);
+  // Whether the value is tracked by this process
+  bool inPartition(std::shared_ptr<framework::Value> value);
+
+  // Forget the values no block after this one can use, once the errors of
+  // the block are out
+  void pruneDeadValues(std::shared_ptr<framework::BasicBlock> block);
+
+  // Log the access paths cut at the depth limit, for -fitx-access-path-stats
+  void reportAccessPaths();
+
+  // Solve the functions with the IFDS backend instead
+  void tabulate(
+      const std::vector<std::shared_ptr<framework::Function>>& functions);
+
+  // Whether the values used at file:line[:column] can reach a bug state. The
+  // answer and the traces leading there are logged.
+  bool query(
+      const std::string& location,
+      const std::vector<std::shared_ptr<framework::Function>>& functions);
+
+  // Called whenever the analysis of a function starts, and every second or
+  // so while a long one runs
+  void setProgressCallback(ProgressCallback callback) { progress_ = callback; }
+  void setCandidateFilter(CandidateFilter filter) { candidate_filter_ = filter; }
+  // The memory budget the partition workers reserve from (0: unlimited)
+  void setMemoryBudget(uint64_t bytes) { memory_budget_ = bytes; }
+
  private:
   llvm::Module& llvm_module_;
   framework::StateManager& state_manager_;
   framework::LoggingClient& log_;
+  framework::AnalysisContext& context_;
 
   std::stack<std::shared_ptr<framework::Function>> analyzing_function_;
 
@@ -102,5 +166,16 @@ class Analyzer {
       function_info_;
 
   std::shared_ptr<framework::BasicBlockInformation> bb_info_;
+
+  ProgressCallback progress_;
+  std::chrono::steady_clock::time_point last_progress_;
+  CandidateFilter candidate_filter_;
+
+  std::shared_ptr<framework::Function> partitioned_function_;
+  std::unique_ptr<framework::ValuePartition> value_partition_;
+  std::set<size_t> partitions_;
+  uint64_t memory_budget_ = 0;
+  std::unique_ptr<framework::CandidateScan> candidate_scan_;
+  framework::TransitionTableCache transition_tables_;
 };
 }  // namespace framework
@@ -37,6 +37,7 @@
 #include <vector>
 
 #include "State.hpp"
+#include "TransitionTable.hpp"
 #include "Value.hpp"
 #include "core/BasicBlock.hpp"
 #include "core/Function.hpp"
@@ -98,6 +99,8 @@ class ArgValueStates {
   void print();
 
  private:
+  void indexValue(uint64_t arg, std::shared_ptr<framework::Value> value);
+
   /* std::vector< */
   /*     std::map<std::shared_ptr<framework::Value>,
    * std::vector<TransitionLogs>>> */
@@ -107,6 +110,13 @@ class ArgValueStates {
       value_states_;
 
   const std::set<State> states_;
+
+  // The argument values with a log from the init state into a bug state, by
+  // that state. Entries are dropped once they are found to no longer match,
+  // so a bucket may hold stale ones but never misses a value.
+  std::map<framework::State,
+           std::set<std::pair<uint64_t, std::shared_ptr<framework::Value>>>>
+      bug_values_;
 };
 
 class BasicBlockValueStates {
@@ -120,6 +130,11 @@ class BasicBlockValueStates {
   bool transitionState(std::vector<Transition>& transitions,
                        std::shared_ptr<framework::Value> value,
                        std::shared_ptr<framework::Instruction> instruction);
+  // transitionState on each of the values, returning the changed ones
+  std::vector<std::shared_ptr<framework::Value>> transitionStates(
+      const TransitionTable& table,
+      const std::vector<std::shared_ptr<framework::Value>>& values,
+      std::shared_ptr<framework::Instruction> instruction);
 
   void setValueState(std::shared_ptr<framework::Value> value,
                      framework::Transition& states,
@@ -145,10 +160,24 @@ class BasicBlockValueStates {
     return value_states_;
   };
 
+  // Forget the values the predicate holds for
+  void removeValues(
+      const std::function<bool(const std::shared_ptr<framework::Value>&,
+                               const TransitionLogs&)>& remove);
+
   void print();
 
  private:
+  void indexValue(std::shared_ptr<framework::Value> value,
+                  const framework::TransitionLogs& logs);
+
   std::map<std::shared_ptr<framework::Value>, TransitionLogs> value_states_;
+
+  // The values that went into a bug state, by that state. Entries are dropped
+  // once the value is found to have left the state, so a bucket may hold
+  // stale values but never misses one.
+  std::map<framework::State, std::set<std::shared_ptr<framework::Value>>>
+      bug_values_;
 };
 
 class BasicBlockInformation {
@@ -169,6 +198,10 @@ class BasicBlockInformation {
   bool changeValueState(std::vector<Transition>& transitions,
                         std::shared_ptr<framework::Value> value,
                         std::shared_ptr<framework::Instruction> instruction);
+  std::vector<std::shared_ptr<framework::Value>> changeValueStates(
+      TransitionTable& table,
+      const std::set<std::shared_ptr<framework::Value>>& values,
+      std::shared_ptr<framework::Instruction> instruction);
   bool valueHasState(std::shared_ptr<framework::Value> value);
   void removeValueFromState(
       std::shared_ptr<framework::Value> value,
@@ -0,0 +1,32 @@
+#pragma once
+#include <map>
+#include <memory>
+
+#include "Function.hpp"
+#include "State.hpp"
+
+namespace framework {
+// Tier-0 scan of the framework IR. It over-approximates whether the analysis
+// of a function can reach a bug state of the detector, by counting the calls
+// that trigger a transition in the function and its callees. A bug state
+// needing two such calls (e.g. two frees for a double free) cannot be
+// reached by a function making at most one, so the full analysis skips it.
+class CandidateScan {
+ public:
+  CandidateScan(framework::StateManager& state_manager);
+
+  bool isCandidate(std::shared_ptr<framework::Function> function);
+
+ private:
+  // Least number of transition calls on a path from the init state to a
+  // bug state
+  unsigned requiredCalls(framework::StateManager& state_manager);
+  unsigned countCalls(std::shared_ptr<framework::Function> function);
+
+  std::shared_ptr<framework::StateTransitionManager> transition_manager_;
+  unsigned required_calls_;
+
+  // Saturated at required_calls_
+  std::map<std::shared_ptr<framework::Function>, unsigned> calls_;
+};
+}  // namespace framework
@@ -3,5 +3,57 @@
 namespace framework {
   namespace CommandLineArgs {
     llvm::cl::opt<bool> Flex("flex", llvm::cl::desc("Print all possible errors"));
+    llvm::cl::opt<unsigned> FunctionBudget(
+        "fitx-function-budget",
+        llvm::cl::desc("Block visits and value state changes allowed per "
+                       "function before it is summarized conservatively "
+                       "(0: unlimited)"),
+        llvm::cl::init(0));
+    llvm::cl::opt<bool> ScanCandidates(
+        "fitx-candidate-scan",
+        llvm::cl::desc("Skip the functions that a cheap scan proves cannot "
+                       "reach a bug state"),
+        llvm::cl::init(true));
+    llvm::cl::opt<bool> SparseStates(
+        "fitx-sparse-states",
+        llvm::cl::desc("Propagate the states only through the blocks that "
+                       "can change them"),
+        llvm::cl::init(true));
+    llvm::cl::opt<bool> Ifds(
+        "fitx-ifds",
+        llvm::cl::desc("Solve the states with the IFDS tabulation backend, "
+                       "which summarizes the functions per entry fact"),
+        llvm::cl::init(false));
+    llvm::cl::opt<std::string> QueryLocation(
+        "fitx-query",
+        llvm::cl::desc("Only check whether the values used at "
+                       "file:line[:column] can reach a bug state. Answered "
+                       "by the IFDS backend, so it may differ from the "
+                       "reports of the default analysis"),
+        llvm::cl::init(""));
+    llvm::cl::opt<unsigned> PartitionBlocks(
+        "fitx-partition-blocks",
+        llvm::cl::desc("Split the values of entry functions with at least "
+                       "this many blocks over workers (0: never)"),
+        llvm::cl::init(2000));
+    llvm::cl::opt<unsigned> PartitionJobs(
+        "fitx-partition-jobs",
+        llvm::cl::desc("Workers the values of a huge function are split over"),
+        llvm::cl::init(4));
+    llvm::cl::opt<bool> PruneDeadValues(
+        "fitx-prune-dead-values",
+        llvm::cl::desc("Drop the states of the values no later block can use, "
+                       "unless they are still to be reported"),
+        llvm::cl::init(true));
+    llvm::cl::opt<bool> ReleaseFunctionStates(
+        "fitx-release-function-states",
+        llvm::cl::desc("Free the block states of a function once it is "
+                       "analyzed, keeping only what its callers read"),
+        llvm::cl::init(true));
+    llvm::cl::opt<bool> AccessPathStats(
+        "fitx-access-path-stats",
+        llvm::cl::desc("Log how many access paths were cut at "
+                       "-fitx-access-path-depth"),
+        llvm::cl::init(false));
   }
 }
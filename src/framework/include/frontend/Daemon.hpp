@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "frontend/State.hpp"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace framework {
+namespace daemon {
+// Wire format used between the compiler plugin and fitxd. A request is a
+// RequestHeader followed by the module name, the detectors to run (one
+// detectorKey per line) and the snapshot taken as the framework IR was
+// generated (see framework_ir/Snapshot.hpp), so that the daemon analyzes the
+// module as it was before the optimizations. The daemon answers with a
+// ReplyStatus, then streams the plain text reports until it closes the
+// socket.
+constexpr uint32_t kMagic = 0x78546946;  // "FiTx"
+constexpr uint32_t kProtocolVersion = 3;
+
+enum RequestFlags : uint32_t {
+  NONE = 0,
+  // The client will not wait for the reports, so the daemon prints them
+  NO_REPLY = 1 << 0,
+};
+
+// UNKNOWN_DETECTORS: the client runs a detector the daemon does not have,
+// so it analyzes the module itself
+enum ReplyStatus : uint32_t { ACCEPTED = 0, UNKNOWN_DETECTORS = 1 };
+
+struct RequestHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t flags;
+  uint32_t name_size;
+  uint32_t detectors_size;
+  uint64_t snapshot_size;
+};
+
+// Names a detector on both ends by the sorted names of its bug states
+std::string detectorKey(framework::StateManager& manager);
+
+bool writeAll(int fd, const void* data, size_t size);
+bool readAll(int fd, void* data, size_t size);
+
+int connectSocket(const std::string& path);
+int listenSocket(const std::string& path);
+
+class DaemonClient {
+ public:
+  DaemonClient(const std::string& socket_path);
+  ~DaemonClient();
+
+  bool connected() { return fd_ >= 0; }
+
+  // Hand the snapshot of the module over to the daemon, to be analyzed with
+  // the given detectors. False when the daemon refused it.
+  bool sendModule(llvm::Module& M, llvm::StringRef snapshot, bool wait_reply,
+                  const std::vector<std::string>& detectors);
+
+  // Relay the reports streamed back by the daemon until it closes the socket
+  void relayReports(llvm::raw_ostream& stream);
+
+ private:
+  int fd_;
+};
+}  // namespace daemon
+}  // namespace framework
@@ -38,17 +38,20 @@
 #include "BasicBlock.hpp"
 #include "core/BasicBlock.hpp"
 #include "core/Function.hpp"
+#include "core/SFG/StateFlowGraph.hpp"
 
 #define NO_ERROR 0
 
 namespace framework {
+class ValueLiveness;
 
 class FunctionInformation {
  public:
   using WeakBasicBlockSet =
       std::set<std::weak_ptr<framework::BasicBlock>, std::owner_less<>>;
 
-  enum AnalysisStat { UNANALYZED, IN_PROGRESS, DIRTY, ANALYZED };
+  // OVER_BUDGET: the analysis stopped on the per-function budget
+  enum AnalysisStat { UNANALYZED, IN_PROGRESS, DIRTY, ANALYZED, OVER_BUDGET };
   static constexpr int kErrorCode = -1;
   static constexpr int kSuccessCode = 0;
 
@@ -87,6 +90,24 @@ class FunctionInformation {
 
   AnalysisStat Stat() { return stat_; }
 
+  // Propagate the states along the graph instead of the CFG
+  void setStateFlowGraph(std::shared_ptr<StateFlowGraph> graph) {
+    state_flow_graph_ = graph;
+  }
+  std::shared_ptr<StateFlowGraph> getStateFlowGraph() {
+    return state_flow_graph_;
+  }
+
+  // Drop the states of the values that are dead after a block
+  void setValueLiveness(std::shared_ptr<ValueLiveness> liveness) {
+    value_liveness_ = liveness;
+  }
+  std::shared_ptr<ValueLiveness> getValueLiveness() { return value_liveness_; }
+
+  // Block visits and value state changes, counted against the budget
+  void countStep() { steps_++; }
+  uint64_t Steps() { return steps_; }
+
   bool basicBlockInfoChanged(std::shared_ptr<framework::BasicBlock> block);
 
   const WeakBasicBlockSet& getErrorBlocks(int64_t error_code);
@@ -99,6 +120,16 @@ class FunctionInformation {
     return return_info_;
   };
 
+  // The argument states of a block of the return value info, also once the
+  // analysis state is released
+  const ArgValueStates* getReturnArgValueStates(
+      std::shared_ptr<framework::BasicBlock> basic_block);
+
+  // Keep only what the callers read (the return value info, the argument
+  // states of its blocks and the values) and free the states of the blocks
+  // in one go
+  void releaseAnalysisState();
+
   std::shared_ptr<framework::Function> Function() {
     return framework_function_;
   }
@@ -117,6 +148,9 @@ class FunctionInformation {
   // Found call inst as return value
   std::shared_ptr<framework::Function> framework_function_;
   AnalysisStat stat_;
+  uint64_t steps_ = 0;
+  std::shared_ptr<StateFlowGraph> state_flow_graph_;
+  std::shared_ptr<ValueLiveness> value_liveness_;
 
   ValueCollection value_collection_;
   AliasValues alias_info_;
@@ -135,6 +169,9 @@ class FunctionInformation {
       prev_basic_block_info_;
 
   std::map<int64_t, WeakBasicBlockSet> return_info_;
+
+  bool released_ = false;
+  std::map<framework::BasicBlock*, ArgValueStates> return_arg_states_;
 };
 
 };  // namespace framework
@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+#include <vector>
+
+namespace framework {
+// Client of the GNU make jobserver advertised in MAKEFLAGS
+// (--jobserver-auth=R,W, --jobserver-auth=fifo:PATH or --jobserver-fds=R,W).
+// The compiler process already owns the implicit job slot, so only the extra
+// analyzer processes need a token.
+class Jobserver {
+ public:
+  Jobserver();
+  ~Jobserver();
+
+  bool active() { return read_fd_ >= 0 && write_fd_ >= 0; }
+
+  // Take a token without blocking. Returns false if none is free.
+  bool acquire();
+
+  // Hand back the last acquired token. Called by the process the token was
+  // acquired for, once it is done. make asks for the very byte that was read,
+  // so the held tokens are kept.
+  void release();
+
+ private:
+  bool openPipe(const std::string& auth);
+  bool openFifo(const std::string& path);
+
+  int read_fd_ = -1;
+  int write_fd_ = -1;
+  bool owns_write_fd_ = false;
+  std::vector<char> tokens_;
+};
+}  // namespace framework
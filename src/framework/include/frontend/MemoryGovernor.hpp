@@ -0,0 +1,88 @@
+#pragma once
+#include <pthread.h>
+#include <sys/types.h>
+
+#include <chrono>
+#include <cstdint>
+
+namespace framework {
+// Admission control of the analyzer memory across every compiler process of
+// the user. Reservations are kept in a shared memory segment, so that
+// concurrent compiles wait for each other instead of getting OOM killed.
+// The memory used per analysis unit (instructions and values of the
+// framework IR) is learned from the finished analyzers. The segment is
+// unlinked once the last reservation is released.
+class MemoryGovernor {
+ public:
+  constexpr static int kNoReservation = -1;
+  constexpr static int kMaxReservations = 256;
+
+  MemoryGovernor(uint64_t budget_bytes);
+  ~MemoryGovernor();
+
+  bool active() { return state_ != nullptr; }
+
+  uint64_t estimate(uint64_t units);
+
+  // Reserve the memory, waiting at most for the timeout. Returns
+  // kNoReservation if the budget is still exhausted by then.
+  int reserve(uint64_t bytes, std::chrono::milliseconds timeout);
+
+  // Hand the reservation over to the calling (forked) process, so that it is
+  // reclaimed if that process dies
+  void adopt(int reservation);
+
+  // Release the reservation, recording how much memory the analysis of the
+  // units actually used
+  void release(int reservation, uint64_t units, uint64_t used_bytes);
+
+  // Current resident set size of the process
+  static uint64_t residentSize();
+  // Restart the peak resident set size of the process from the current
+  // size. False if the kernel cannot.
+  static bool resetPeakResidentSize();
+  // Peak resident set size since the process started or the last reset
+  static uint64_t peakResidentSize();
+
+  // How far the resident set of the process grows from the construction on
+  class Growth {
+   public:
+    Growth();
+    uint64_t Peak() const;
+
+   private:
+    uint64_t initial_resident_size_;
+    bool peak_reset_;
+  };
+
+ private:
+  struct Reservation {
+    pid_t pid;
+    uint64_t bytes;
+  };
+
+  struct State {
+    uint32_t magic;
+    uint32_t version;
+    pthread_mutex_t mutex;
+    pthread_cond_t released;
+    uint64_t budget;
+    uint64_t reserved;
+    uint64_t bytes_per_unit;
+    bool unlinked;
+    Reservation reservations[kMaxReservations];
+  };
+
+  // Map the segment of the user, creating it if needed. False if it cannot,
+  // or if it was unlinked in the meantime.
+  bool attach();
+  void detach();
+  bool lock();
+  void unlock();
+  void reclaimDeadReservations();
+  int tryReserve(uint64_t bytes);
+
+  uint64_t budget_;
+  State* state_ = nullptr;
+};
+}  // namespace framework
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Function.hpp"
+#include "core/Instructions.hpp"
+#include "State.hpp"
+
+namespace framework {
+// Runs the state machines of up to 64 detectors at once over the framework
+// IR, to tell which detectors may reach a bug state in a function. The states
+// are bit-sliced over the detectors: one word per state index, where bit k
+// is set when a value may be in that state of detector k. A transition of all
+// the detectors is then a few ANDs and ORs per instruction, and the join of
+// two paths is an OR.
+//
+// The values are not told apart and no state is ever left, so the result
+// over-approximates the analysis of each detector on its own.
+class MultiAutomaton {
+ public:
+  using Word = uint64_t;
+  static constexpr size_t kMaxDetectors = 64;
+
+  MultiAutomaton(std::vector<framework::StateManager>& managers);
+
+  // Bit k is set when detector k may reach a bug state while analyzing the
+  // function. The detectors past kMaxDetectors are left out.
+  Word Candidates(std::shared_ptr<framework::Function> function);
+
+ private:
+  using States = std::vector<Word>;
+
+  // next[source][target] holds the detectors moving from source to target
+  struct Event {
+    std::vector<std::vector<Word>> next;
+    bool empty = true;
+  };
+
+  struct Summary {
+    States exit;
+    Word bugs;
+  };
+
+  using TransitionsOf =
+      std::function<std::vector<Transition>(StateTransitionManager&)>;
+  const Event& event(const std::string& key, TransitionsOf transitions);
+
+  void step(States& states, const Event& event);
+  void closure(States& states, const std::set<std::string>& events);
+  Word bugs(const States& states) const;
+
+  Summary analyze(std::shared_ptr<framework::Function> function,
+                  const States& entry);
+  void transfer(std::shared_ptr<framework::Instruction> inst, States& states,
+                Word& bugs);
+  bool transferArguments(std::shared_ptr<framework::CallInst> call_inst,
+                         States& states);
+  void transferBranch(std::shared_ptr<framework::BasicBlock> block,
+                      States& states);
+  const std::set<std::string>& Events(
+      std::shared_ptr<framework::Function> function);
+
+  std::vector<framework::StateManager*> managers_;
+  std::vector<std::vector<const State*>> states_;
+  size_t state_num_ = 0;
+
+  // The init states are always there, since a new value may appear anywhere
+  States init_;
+  States bug_;
+
+  std::map<std::string, Event> events_;
+  std::map<std::pair<framework::Function*, States>, Summary> summaries_;
+  std::set<framework::Function*> active_;
+  // The events of a function and its callees, for recursive calls
+  std::map<framework::Function*, std::set<std::string>> function_events_;
+  // The keys of the events looked up while walking a function for its events
+  std::set<std::string>* recording_ = nullptr;
+};
+}  // namespace framework
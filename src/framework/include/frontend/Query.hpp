@@ -0,0 +1,63 @@
+#pragma once
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "core/BasicBlock.hpp"
+#include "core/Function.hpp"
+#include "core/Instructions.hpp"
+
+namespace framework {
+// A demand-driven query for the values used at a debug location. Only the
+// blocks the location depends on are analyzed: the ones reaching it or
+// reached from it in its function, and, for the values that are arguments,
+// the ones reaching the call sites in the callers or reached from them. The
+// callees are analyzed on their calls.
+class Query {
+ public:
+  // The location is file:line[:column]
+  Query(const std::string& location);
+
+  bool isValid() const { return line_ != 0; }
+  const std::string& Location() const { return location_; }
+
+  void collect(const std::vector<std::shared_ptr<framework::Function>>& functions);
+
+  bool matches(framework::Instruction* inst) const;
+  bool isQueriedValue(const std::shared_ptr<framework::Value>& value) const;
+  // Blocks outside of the queried functions are analyzed on demand
+  bool isDemanded(framework::BasicBlock* block) const;
+
+  const std::vector<std::shared_ptr<framework::Instruction>>& Instructions()
+      const {
+    return instructions_;
+  }
+  const std::vector<std::shared_ptr<framework::Function>>& Entries() const {
+    return entries_;
+  }
+
+  // The values whose state the instruction may change
+  static std::vector<std::shared_ptr<framework::Value>> UsedValues(
+      std::shared_ptr<framework::Instruction> inst);
+
+ private:
+  void addBlocks(std::shared_ptr<framework::Function> function,
+                 std::vector<std::shared_ptr<framework::BasicBlock>> blocks,
+                 bool forward);
+  void addCallers(std::shared_ptr<framework::Function> function,
+                  std::set<uint64_t> arguments);
+
+  std::string location_;
+  std::string file_;
+  unsigned line_ = 0;
+  unsigned column_ = 0;
+
+  std::vector<std::shared_ptr<framework::Instruction>> instructions_;
+  std::vector<std::shared_ptr<framework::Value>> values_;
+  std::vector<std::shared_ptr<framework::Function>> entries_;
+  std::set<framework::Function*> functions_;
+  std::set<framework::BasicBlock*> blocks_;
+  std::set<std::pair<framework::Function*, uint64_t>> walked_arguments_;
+};
+}  // namespace framework
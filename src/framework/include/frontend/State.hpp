@@ -89,6 +89,7 @@ class State {
   bool operator==(const StateArgs& args) const;
   State& operator=(const State& state);
 
+  int ID() const { return ID_; }
   std::string Name() const { return name_; };
 
   bool isInitState() const { return type_ == StateType::INIT; }
@@ -100,7 +101,7 @@ class State {
 
   const framework::StateMergeMethod MergeMethod() { return method_; };
 
-  const framework::BugNotificationTiming NotificationTiming() {
+  const framework::BugNotificationTiming NotificationTiming() const {
     return timing_;
   }
 
@@ -235,6 +236,14 @@ class StateTransitionManager {
 
   std::vector<framework::Transition> getAliasTransitions();
 
+  /* Candidate scan */
+  // Whether calling the function triggers a transition, either on its
+  // arguments or on the stored return value
+  bool isTransitionFunction(const std::string& name);
+  // Transitions triggered by such calls, and by any store, use or alias
+  std::vector<framework::Transition> getCallTransitions();
+  std::vector<framework::Transition> getValueTransitions();
+
  private:
   /* Register Function Arg Transition Rule*/
   void registerFunctionArgTransition(
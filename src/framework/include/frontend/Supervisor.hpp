@@ -0,0 +1,81 @@
+#pragma once
+#include <sys/types.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Logs.hpp"
+#include "llvm/Support/raw_ostream.h"
+
+namespace framework {
+// Runs analyzers in forked workers under resource limits. The workers stream
+// their reports and a heartbeat naming the function being analyzed, so that
+// a worker that is killed still yields its reports and the function it was
+// stuck in.
+class Supervisor {
+ public:
+  struct Limits {
+    unsigned cpu_seconds = 0;
+    // Growth of the address space over the one of the compiler
+    uint64_t address_space = 0;
+    // Wall clock time of the worker, and without any heartbeat
+    unsigned timeout = 0;
+    unsigned stall_timeout = 0;
+
+    bool enabled() const {
+      return cpu_seconds || address_space || timeout || stall_timeout;
+    }
+  };
+
+  struct Worker {
+    int id;
+    std::string name;
+    pid_t pid;
+    int log_fd;
+    int heartbeat_fd;
+
+    std::string log;
+    std::string heartbeat;
+    std::string current_function;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point last_heartbeat;
+    const char* kill_reason = nullptr;
+    // The resident set size at the fork and the peak one of the worker
+    uint64_t initial_resident_size = 0;
+    uint64_t max_resident_size = 0;
+  };
+
+  using Heartbeat = std::function<void(const std::string& function)>;
+  using Task = std::function<void(LoggingClient& log, Heartbeat heartbeat)>;
+
+  Supervisor(const std::string& module_name, const Limits& limits);
+
+  // Fork a worker running the task. Returns its id, or -1 on failure.
+  int spawn(const std::string& name, Task task);
+
+  // Supervise the running workers until one of them exits. Its reports, and
+  // an [ABORTED] record if it did not finish, are written to the output.
+  bool waitAny(llvm::raw_ostream& output, Worker& finished);
+
+  size_t Running() { return workers_.size(); }
+
+  // Called by a process a worker forks, so that the supervisor sees the
+  // pipes of the worker close when the worker exits
+  static void closeWorkerPipes();
+
+ private:
+  void applyLimits();
+  void killStalledWorkers();
+  bool readWorker(Worker& worker, int fd);
+  void reapWorker(size_t index, llvm::raw_ostream& output, Worker& finished);
+
+  std::string module_name_;
+  Limits limits_;
+  int next_id_ = 0;
+  std::vector<std::unique_ptr<Worker>> workers_;
+};
+}  // namespace framework
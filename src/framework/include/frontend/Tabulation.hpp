@@ -0,0 +1,143 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "Logs.hpp"
+#include "State.hpp"
+#include "core/BasicBlock.hpp"
+#include "core/Function.hpp"
+#include "core/Instructions.hpp"
+#include "frontend/Query.hpp"
+
+namespace framework {
+// IFDS tabulation over the framework IR. A fact is a value in a state of the
+// detector. The StateManager transitions apply to each fact on its own, which
+// makes them distributive flow functions. The exit facts of a function are
+// memoized per entry fact, so a callee is only analyzed again for an entry
+// fact (an argument in a state) it has not been seen with.
+class TabulationSolver {
+ public:
+  // flex reports the bugs on arbitrary array elements as well
+  TabulationSolver(framework::StateManager& state_manager,
+                   framework::LoggingClient& log, bool flex);
+
+  void solve(
+      const std::vector<std::shared_ptr<framework::Function>>& functions);
+
+  // Only solve the blocks the query demands, and only report on it
+  void setQuery(const framework::Query* query) { query_ = query; }
+  size_t Reports() const { return reported_.size(); }
+
+ private:
+  struct Fact {
+    // nullptr for the zero fact. Its state is nullptr when the function is
+    // analyzed on its own, and the init state when it is called.
+    std::shared_ptr<framework::Value> value;
+    const framework::State* state;
+    // The trace of the path that brought the value into the state. It is not
+    // part of the order, so a path edge keeps the trace of the first path
+    // reaching it.
+    std::shared_ptr<const TransitionLogs> logs = nullptr;
+
+    bool isZero() const { return !value; }
+    // By value, as the same value may be built more than once
+    bool operator<(const Fact& fact) const {
+      if (!value || !fact.value) {
+        if (value || fact.value) return !value;
+      } else if (*value < *fact.value || *fact.value < *value) {
+        return *value < *fact.value;
+      }
+      if (!state || !fact.state) return !state && fact.state;
+      return *state < *fact.state;
+    }
+  };
+
+  // The point before the instruction at the index, or the end of the block
+  struct Node {
+    std::shared_ptr<framework::BasicBlock> block;
+    size_t index;
+
+    bool operator<(const Node& node) const {
+      return std::tie(block, index) < std::tie(node.block, node.index);
+    }
+  };
+
+  struct PathEdge {
+    Fact entry;
+    Node node;
+    Fact fact;
+
+    bool operator<(const PathEdge& edge) const {
+      return std::tie(entry, node, fact) <
+             std::tie(edge.entry, edge.node, edge.fact);
+    }
+  };
+
+  using Context = std::pair<std::shared_ptr<framework::Function>, Fact>;
+
+  void propagate(const Fact& entry, const Node& node, const Fact& fact);
+  void processCall(const PathEdge& edge,
+                   std::shared_ptr<framework::CallInst> call_inst);
+  void processExit(const PathEdge& edge);
+  void processBlockEnd(const PathEdge& edge);
+
+  // Flow functions
+  std::vector<Fact> flowEntry(std::shared_ptr<framework::Function> function,
+                              bool arguments);
+  std::vector<Fact> flowInstruction(
+      std::shared_ptr<framework::Instruction> inst, const Fact& fact);
+  std::vector<Fact> flowEdge(std::shared_ptr<framework::BasicBlock> block,
+                             std::shared_ptr<framework::BasicBlock> successor,
+                             const Fact& fact);
+  std::vector<Fact> flowCallToStart(
+      std::shared_ptr<framework::CallInst> call_inst, const Fact& fact);
+  std::vector<Fact> flowExitToReturn(
+      const PathEdge& caller, std::shared_ptr<framework::CallInst> call_inst,
+      const Fact& exit_entry, const Fact& fact);
+  bool passedToCallee(std::shared_ptr<framework::CallInst> call_inst,
+                      const Fact& fact);
+
+  Fact transit(const Fact& fact, std::shared_ptr<framework::Value> value,
+               const std::vector<Transition>& transitions,
+               std::shared_ptr<framework::Instruction> inst);
+  Fact rename(const Fact& fact, std::shared_ptr<framework::Value> value);
+
+  bool analyzedCallee(std::shared_ptr<framework::CallInst> call_inst);
+  const std::vector<std::shared_ptr<framework::Instruction>>& Instructions(
+      std::shared_ptr<framework::BasicBlock> block);
+  const std::vector<std::shared_ptr<framework::Value>>& touchedValues(
+      std::shared_ptr<framework::Function> function);
+  const framework::State* getState(const framework::State& state);
+
+  void report(const Fact& fact, std::shared_ptr<framework::Instruction> inst,
+              framework::BugNotificationTiming timing,
+              std::shared_ptr<framework::Function> function = nullptr);
+
+  framework::StateManager& state_manager_;
+  framework::LoggingClient& log_;
+  bool flex_;
+  const framework::Query* query_ = nullptr;
+  const framework::State* init_state_ = nullptr;
+
+  std::set<PathEdge> path_edges_;
+  std::vector<PathEdge> worklist_;
+
+  // Memoized exit facts, and the path edges of the calls waiting for them
+  std::map<Context, std::set<Fact>> end_summaries_;
+  std::map<Context, std::set<PathEdge>> incoming_;
+
+  std::set<std::tuple<framework::Instruction*, framework::Value*,
+                      const framework::State*>>
+      reported_;
+
+  std::map<framework::BasicBlock*,
+           std::vector<std::shared_ptr<framework::Instruction>>>
+      instructions_;
+  std::map<std::shared_ptr<framework::Function>,
+           std::vector<std::shared_ptr<framework::Value>>>
+      touched_values_;
+};
+}  // namespace framework
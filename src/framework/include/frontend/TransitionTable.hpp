@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "State.hpp"
+
+namespace framework {
+// A transition list compiled over dense state indices, so that it is applied
+// to the states of many values at once: the state indices of the values are
+// gathered into a column, looked up in the table and the changed ones are
+// scattered back.
+class TransitionTable {
+ public:
+  static constexpr uint8_t kNone = 0xFF;
+
+  // The table refers to the states and the transitions, which have to outlive
+  // it
+  TransitionTable(const std::set<State>& states,
+                  std::vector<Transition>& transitions);
+
+  // False when a transition leaves a state outside of the states, which only
+  // the per-value path handles
+  bool isValid() const { return valid_; }
+
+  uint8_t Index(const State& state) const;
+  // The first transition leaving the state at the index, or nullptr
+  const Transition* TransitionFrom(uint8_t index) const {
+    return index < transitions_.size() ? transitions_[index] : nullptr;
+  }
+  // The transition taken by a value without a state yet
+  const Transition* InitTransition() const { return init_transition_; }
+  std::vector<Transition>& Transitions() { return transitions_list_; }
+
+  // Replace each index of the column with the index of its next state, or
+  // kNone when no transition leaves it
+  void apply(uint8_t* column, size_t size) const;
+
+ private:
+  std::vector<const State*> states_;
+  std::vector<Transition>& transitions_list_;
+  std::vector<uint8_t> next_;
+  std::vector<const Transition*> transitions_;
+  const Transition* init_transition_ = nullptr;
+  bool valid_ = true;
+};
+
+// The tables of the transition lists applied so far, so that each list is
+// compiled once rather than on every bulk update
+class TransitionTableCache {
+ public:
+  // The states have to outlive the cache
+  explicit TransitionTableCache(const std::set<State>& states)
+      : states_(states) {}
+
+  // The table of a list with the same transitions, built on first use
+  TransitionTable& get(const std::vector<Transition>& transitions);
+
+ private:
+  struct Entry {
+    std::vector<Transition> transitions;
+    std::unique_ptr<TransitionTable> table;
+  };
+
+  const std::set<State>& states_;
+  // Keyed by the source and target of each transition, in order
+  std::map<std::vector<std::pair<int, int>>, Entry> tables_;
+};
+}  // namespace framework
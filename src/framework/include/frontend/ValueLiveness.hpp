@@ -0,0 +1,32 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "Function.hpp"
+#include "ValuePartition.hpp"
+#include "core/Value.hpp"
+#include "llvm/ADT/BitVector.h"
+
+namespace framework {
+// Which values of a function may still be used after a block. A value is
+// live while any block reachable from the block uses a value of its group,
+// so a value is kept as long as anything it aliases through a store is. The
+// arguments, the globals and the values returned stay live to the end, as
+// the callers and the other functions see them.
+class ValueLiveness {
+ public:
+  ValueLiveness(std::shared_ptr<framework::Function> function);
+
+  bool isLiveOut(std::shared_ptr<framework::BasicBlock> block,
+                 const framework::Value& value);
+
+ private:
+  ValueGroups groups_;
+  std::map<const llvm::Value*, unsigned> group_index_;
+  std::set<unsigned> returned_groups_;
+  // By block id, the groups used by the blocks reachable from the block
+  std::vector<llvm::BitVector> live_out_;
+};
+}  // namespace framework
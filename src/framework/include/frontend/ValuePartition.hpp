@@ -0,0 +1,57 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "Function.hpp"
+#include "core/Value.hpp"
+
+namespace llvm {
+class Value;
+}
+
+namespace framework {
+// The roots of the values used in a function, grouped so that values sharing
+// a root (i.e. fields of the same value), values tied by a store, through
+// which they alias, and the arguments and result of a call, which the callee
+// may tie, end up in the same group.
+class ValueGroups {
+ public:
+  ValueGroups(std::shared_ptr<framework::Function> function);
+
+  // The values the instructions and then the branch of the block use
+  static std::vector<std::shared_ptr<framework::Value>> UsedValues(
+      std::shared_ptr<framework::BasicBlock> block);
+
+  // The roots in the order they are first used, so that anything built on
+  // the groups does not depend on the addresses
+  const std::vector<const llvm::Value*>& Roots() const { return roots_; }
+  bool contains(const llvm::Value* root) const { return parent_.count(root); }
+  // The root standing for the group of the root
+  const llvm::Value* find(const llvm::Value* root);
+
+ private:
+  void unite(const llvm::Value* lhs, const llvm::Value* rhs);
+  void addRoot(std::shared_ptr<framework::Value> value);
+
+  std::vector<const llvm::Value*> roots_;
+  std::map<const llvm::Value*, const llvm::Value*> parent_;
+};
+
+// Splits the values tracked in a function into parts whose states evolve
+// independently. The groups of values are balanced over the parts, and each
+// part is then analyzed on its own.
+class ValuePartition {
+ public:
+  ValuePartition(std::shared_ptr<framework::Function> function, size_t parts);
+
+  // The number of non-empty parts
+  size_t Parts() const { return parts_; }
+  // Values never seen in the function belong to the first part
+  size_t PartOf(const framework::Value& value) const;
+
+ private:
+  std::map<const llvm::Value*, size_t> part_;
+  size_t parts_ = 0;
+};
+}  // namespace framework
@@ -0,0 +1,380 @@
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "All_Detector.hpp"
+#include "core/Logs.hpp"
+#include "framework_ir/IRGenerator.hpp"
+#include "framework_ir/Shards.hpp"
+#include "framework_ir/Snapshot.hpp"
+#include "frontend/Analyzer.hpp"
+#include "frontend/Daemon.hpp"
+#include "frontend/Framework.hpp"
+#include "frontend/State.hpp"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/Linker/Linker.h"
+#include "llvm/Object/IRObjectFile.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
+
+static llvm::cl::list<std::string> Inputs(
+    llvm::cl::Positional, llvm::cl::OneOrMore,
+    llvm::cl::desc("<.bc/.ll/.o/.fitx files or directories>"));
+
+static llvm::cl::opt<unsigned> Jobs(
+    "j", llvm::cl::desc("Number of modules analyzed in parallel"),
+    llvm::cl::init(std::max(1u, std::thread::hardware_concurrency())));
+
+static llvm::cl::opt<std::string> Output(
+    "o", llvm::cl::desc("Write the merged report to the given file"),
+    llvm::cl::init("-"));
+
+static llvm::cl::opt<bool> WholeProgram(
+    "whole-program",
+    llvm::cl::desc("Link the inputs into one module and analyze its call "
+                   "graph in shards"));
+
+static llvm::cl::opt<unsigned> ShardCount(
+    "shards",
+    llvm::cl::desc("Number of call graph shards in whole-program mode "
+                   "(default: 4 per job)"),
+    llvm::cl::init(0));
+
+// fitx-batch is not loaded into clang, so there is no detector pass to
+// register
+std::vector<framework::FrameworkPass*> framework::FrameworkPass::passes;
+
+namespace {
+struct Job {
+  std::string path;
+  uint64_t size;
+  long shard = -1;
+
+  pid_t pid = -1;
+  int fd = -1;
+  std::string report;
+  bool aborted = false;
+};
+
+bool isInputFile(llvm::StringRef path) {
+  llvm::StringRef extension = llvm::sys::path::extension(path);
+  return extension == ".bc" || extension == ".ll" || extension == ".o" ||
+         extension == ".fitx";
+}
+
+void collectJobs(const std::string& input, std::vector<Job>& jobs) {
+  auto addJob = [&jobs](const std::string& path) {
+    uint64_t size = 0;
+    llvm::sys::fs::file_size(path, size);
+    Job job;
+    job.path = path;
+    job.size = size;
+    jobs.push_back(job);
+  };
+
+  if (!llvm::sys::fs::is_directory(input)) {
+    addJob(input);
+    return;
+  }
+
+  std::error_code error;
+  for (llvm::sys::fs::recursive_directory_iterator entry(input, error), end;
+       entry != end && !error; entry.increment(error)) {
+    if (llvm::sys::fs::is_regular_file(entry->path()) &&
+        isInputFile(entry->path()))
+      addJob(entry->path());
+  }
+}
+
+std::unique_ptr<llvm::Module> loadModule(
+    const std::string& path, llvm::LLVMContext& context,
+    std::unique_ptr<llvm::MemoryBuffer>& buffer,
+    std::unique_ptr<ir_generator::snapshot::SnapshotReader>& snapshot) {
+  if (llvm::sys::path::extension(path) == ".fitx") {
+    snapshot = ir_generator::snapshot::SnapshotReader::open(path);
+    return snapshot ? snapshot->loadModule(context) : nullptr;
+  }
+
+  if (llvm::sys::path::extension(path) == ".ll") {
+    llvm::SMDiagnostic diagnostic;
+    auto module = llvm::parseIRFile(path, diagnostic, context);
+    if (!module) diagnostic.print("fitx-batch", llvm::errs());
+    return module;
+  }
+
+  auto file = llvm::MemoryBuffer::getFile(path);
+  if (!file) {
+    llvm::errs() << "fitx-batch: cannot open " << path << "\n";
+    return nullptr;
+  }
+  buffer = std::move(*file);
+
+  // Objects built with -fembed-bitcode carry the module in .llvmbc
+  auto bitcode = llvm::object::IRObjectFile::findBitcodeInMemBuffer(
+      buffer->getMemBufferRef());
+  if (!bitcode) {
+    llvm::errs() << "fitx-batch: " << path << ": "
+                 << llvm::toString(bitcode.takeError()) << "\n";
+    return nullptr;
+  }
+
+  // Loaded in full: the framework IR refers to the instructions, so the
+  // bodies could not be released after generating it anyway
+  auto module = llvm::parseBitcodeFile(*bitcode, context);
+  if (!module) {
+    llvm::errs() << "fitx-batch: " << path << ": "
+                 << llvm::toString(module.takeError()) << "\n";
+    return nullptr;
+  }
+  return std::move(*module);
+}
+
+class BatchDriver {
+ public:
+  // The rule tables are built once and inherited by every forked worker
+  BatchDriver() {
+    for (auto& define_states : def_funcs) {
+      framework::StateManager manager;
+      define_states(manager);
+      managers_.push_back(manager);
+    }
+  }
+
+  void run(std::vector<Job>& jobs);
+
+  // Link the inputs and build the framework IR once, before the workers are
+  // forked, so that they all share it
+  bool linkProgram(const std::vector<Job>& inputs, std::vector<Job>& shards);
+
+ private:
+  void startJob(Job& job);
+  void analyzeModule(const std::string& path, int fd);
+  void analyzeShard(const ir_generator::Shard& shard, int fd);
+  bool readReport(Job& job);
+
+  std::vector<framework::StateManager> managers_;
+
+  llvm::LLVMContext program_context_;
+  std::unique_ptr<llvm::Module> program_;
+  std::vector<ir_generator::Shard> shards_;
+};
+
+void BatchDriver::run(std::vector<Job>& jobs) {
+  // The most expensive modules are started first so that the tail of the
+  // run is filled with small ones
+  std::vector<Job*> queue;
+  for (auto& job : jobs) queue.push_back(&job);
+  std::stable_sort(queue.begin(), queue.end(),
+                   [](Job* a, Job* b) { return a->size > b->size; });
+
+  auto next = queue.begin();
+  std::vector<Job*> running;
+  while (next != queue.end() || !running.empty()) {
+    // Workers pull the next module as soon as they are done
+    while (running.size() < Jobs && next != queue.end()) {
+      startJob(**next);
+      if ((*next)->pid > 0) running.push_back(*next);
+      next++;
+    }
+    if (running.empty()) continue;
+
+    std::vector<struct pollfd> fds;
+    for (auto job : running) fds.push_back({job->fd, POLLIN, 0});
+    if (poll(fds.data(), fds.size(), -1) < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+
+    for (size_t i = 0; i < fds.size(); i++) {
+      if (!fds[i].revents || readReport(*running[i])) continue;
+
+      int status = 0;
+      close(running[i]->fd);
+      waitpid(running[i]->pid, &status, 0);
+      running[i]->aborted = !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+      running[i] = nullptr;
+    }
+    running.erase(std::remove(running.begin(), running.end(), nullptr),
+                  running.end());
+  }
+}
+
+void BatchDriver::startJob(Job& job) {
+  int fd[2];
+  if (pipe(fd) < 0) {
+    job.aborted = true;
+    return;
+  }
+
+  job.pid = fork();
+  if (job.pid == 0) {
+    close(fd[0]);
+    if (job.shard >= 0)
+      analyzeShard(shards_[job.shard], fd[1]);
+    else
+      analyzeModule(job.path, fd[1]);
+    close(fd[1]);
+    exit(0);
+  }
+
+  close(fd[1]);
+  job.fd = fd[0];
+  if (job.pid < 0) {
+    close(fd[0]);
+    job.aborted = true;
+  }
+}
+
+bool BatchDriver::readReport(Job& job) {
+  char buffer[4096];
+  ssize_t size = read(job.fd, buffer, sizeof(buffer));
+  if (size < 0 && errno == EINTR) return true;
+  if (size <= 0) return false;
+
+  job.report.append(buffer, size);
+  return true;
+}
+
+bool BatchDriver::linkProgram(const std::vector<Job>& inputs,
+                              std::vector<Job>& shards) {
+  program_ = std::make_unique<llvm::Module>("fitx-program", program_context_);
+  llvm::Linker linker(*program_);
+
+  for (auto& input : inputs) {
+    std::unique_ptr<llvm::MemoryBuffer> buffer;
+    std::unique_ptr<ir_generator::snapshot::SnapshotReader> snapshot;
+    auto module = loadModule(input.path, program_context_, buffer, snapshot);
+    if (!module || linker.linkInModule(std::move(module))) {
+      llvm::errs() << "fitx-batch: cannot link " << input.path << "\n";
+      return false;
+    }
+  }
+
+  ir_generator::IRGenerator::generate(*program_);
+  shards_ = ir_generator::partitionCallGraph(
+      ir_generator::IRGenerator::FrameworkIR(*program_),
+      ShardCount ? ShardCount : Jobs * 4);
+
+  for (size_t i = 0; i < shards_.size(); i++) {
+    Job job;
+    job.path = "shard " + std::to_string(i);
+    job.size = shards_[i].cost;
+    job.shard = i;
+    shards.push_back(job);
+  }
+  return true;
+}
+
+// The reports of a shard are sent with their keys, for the merge to drop the
+// ones of the callees shared with other shards
+void BatchDriver::analyzeShard(const ir_generator::Shard& shard, int fd) {
+  for (auto& manager : managers_) {
+    std::string log, records;
+    framework::LoggingClient client(log);
+    client.setReportCallback(
+        [&records](const framework::LoggingClient::Report& report) {
+          records += framework::LoggingClient::encodeReport(report);
+        });
+    framework::Analyzer analyzer(*program_, manager, client);
+    analyzer.analyze(shard.functions);
+
+    records += framework::LoggingClient::encodeReport({"", log});
+    if (!framework::daemon::writeAll(fd, records.data(), records.size()))
+      exit(1);
+  }
+}
+
+void BatchDriver::analyzeModule(const std::string& path, int fd) {
+  llvm::LLVMContext context;
+  std::unique_ptr<llvm::MemoryBuffer> buffer;
+  std::unique_ptr<ir_generator::snapshot::SnapshotReader> snapshot;
+  auto module = loadModule(path, context, buffer, snapshot);
+  if (!module) exit(1);
+
+  auto& analysis_context = framework::AnalysisContext::Current();
+  if (!snapshot || !snapshot->loadFrameworkIR(*module, analysis_context))
+    ir_generator::IRGenerator::generate(*module, analysis_context);
+
+  for (auto& manager : managers_) {
+    std::string log;
+    framework::LoggingClient client(log);
+    framework::Analyzer analyzer(*module, manager, client);
+    analyzer.analyze();
+
+    if (!framework::daemon::writeAll(fd, log.data(), log.size())) exit(1);
+  }
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  llvm::InitLLVM X(argc, argv);
+  llvm::cl::ParseCommandLineOptions(argc, argv,
+                                    "FiTx batch analysis of bitcode files\n");
+  if (Jobs == 0) {
+    llvm::errs() << "fitx-batch: -j must be at least 1\n";
+    return 1;
+  }
+
+  std::vector<Job> jobs;
+  for (auto& input : Inputs) collectJobs(input, jobs);
+  std::sort(jobs.begin(), jobs.end(),
+            [](const Job& a, const Job& b) { return a.path < b.path; });
+
+  BatchDriver driver;
+  if (WholeProgram) {
+    std::vector<Job> shards;
+    if (!driver.linkProgram(jobs, shards)) return 1;
+    jobs = shards;
+  }
+  driver.run(jobs);
+
+  std::error_code error;
+  llvm::raw_fd_ostream output(Output, error);
+  if (error) {
+    llvm::errs() << "fitx-batch: cannot open " << Output << "\n";
+    return 1;
+  }
+
+  // One merged report, in the order of the input paths. Shards may report
+  // the bugs of a shared callee more than once.
+  int failed = 0;
+  std::set<std::string> reported;
+  for (auto& job : jobs) {
+    if (job.aborted) {
+      llvm::errs() << "fitx-batch: analysis of " << job.path << " failed\n";
+      failed++;
+    }
+    if (job.report.empty()) continue;
+    if (job.shard < 0) {
+      output << "[File] " << job.path << "\n" << job.report;
+      continue;
+    }
+
+    for (auto& report :
+         framework::LoggingClient::decodeReports(job.report)) {
+      if (report.key.empty() || reported.insert(report.key).second)
+        output << report.text;
+    }
+  }
+
+  llvm::errs() << "fitx-batch: analyzed " << jobs.size() - failed << "/"
+               << jobs.size() << (WholeProgram ? " shards\n" : " modules\n");
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "All_Detector.hpp"
+#include "frontend/Framework.hpp"
+#include "frontend/State.hpp"
+#include "frontend/TransitionTable.hpp"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/raw_ostream.h"
+
+// Micro-benchmarks of the bulk transition table against the per-value
+// search of BasicBlockValueStates::transitionState, and of a whole bulk update
+// as Analyzer::changeValueStates does it, from the transition list to the
+// changed values
+
+static llvm::cl::opt<unsigned> Values(
+    "values", llvm::cl::desc("Values in a bulk update"), llvm::cl::init(64));
+static llvm::cl::opt<unsigned> Iterations(
+    "iterations", llvm::cl::desc("Bulk updates per measurement"),
+    llvm::cl::init(100000));
+
+// There is no detector pass to register
+std::vector<framework::FrameworkPass*> framework::FrameworkPass::passes;
+
+// Nanoseconds per value of the update
+static double measure(const std::function<void()>& update) {
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < Iterations; i++) update();
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / Iterations / Values;
+}
+
+static void benchmark(framework::StateManager& manager) {
+  auto transitions = manager.TransitionManager()->getValueTransitions();
+  if (transitions.empty()) return;
+
+  auto& states = manager.getStates();
+  framework::TransitionTable table(states, transitions);
+  if (!table.isValid()) return;
+
+  std::string bugs;
+  for (auto& state : manager.getBugStates())
+    bugs += (bugs.empty() ? "" : ", ") + state.Name();
+
+  // The states of the values, spread over the states of the detector
+  std::mt19937 random(0);
+  std::vector<framework::State> value_states;
+  std::vector<const framework::State*> all_states;
+  for (auto& state : states) all_states.push_back(&state);
+  for (unsigned i = 0; i < Values; i++)
+    value_states.push_back(*all_states[random() % all_states.size()]);
+
+  volatile size_t sink = 0;
+  double per_value = measure([&]() {
+    for (auto& current_state : value_states) {
+      auto next_transition =
+          std::find_if(transitions.begin(), transitions.end(),
+                       [&current_state](framework::Transition transition) {
+                         return transition.Source() == current_state;
+                       });
+      sink = sink + (next_transition != transitions.end());
+    }
+  });
+
+  llvm::outs() << "[" << bugs << "] " << states.size() << " states, "
+               << transitions.size() << " transitions, " << Values
+               << " values\n";
+  llvm::outs() << "  per-value search  "
+               << llvm::format("%8.2f ns/value\n", per_value);
+
+  // The gather of the state indices, then the table lookup
+  std::vector<uint8_t> column(Values);
+  double gather = measure([&]() {
+    for (unsigned i = 0; i < Values; i++)
+      column[i] = table.Index(value_states[i]);
+    sink = sink + column[0];
+  });
+  std::vector<uint8_t> indices(column);
+  double lookup = measure([&]() {
+    std::copy(indices.begin(), indices.end(), column.begin());
+    table.apply(column.data(), column.size());
+    sink = sink + column[0];
+  });
+  llvm::outs() << "  table             "
+               << llvm::format("%8.2f ns/value (lookup %.2f), %.2fx\n",
+                               gather + lookup, lookup,
+                               per_value / (gather + lookup));
+
+  // The whole update: the table of the list, the gather, the lookup and the
+  // scatter of the changed states
+  auto update = [&](framework::TransitionTable& update_table) {
+    for (unsigned i = 0; i < Values; i++)
+      column[i] = update_table.Index(value_states[i]);
+    std::vector<uint8_t> sources(column);
+    update_table.apply(column.data(), column.size());
+    for (unsigned i = 0; i < Values; i++) {
+      if (column[i] == framework::TransitionTable::kNone) continue;
+      sink = sink + update_table.TransitionFrom(sources[i])->Target().ID();
+    }
+  };
+  double rebuilt = measure([&]() {
+    framework::TransitionTable update_table(states, transitions);
+    update(update_table);
+  });
+  framework::TransitionTableCache cache(states);
+  double cached = measure([&]() { update(cache.get(transitions)); });
+
+  llvm::outs() << "  update rebuilt    "
+               << llvm::format("%8.2f ns/value, %.2fx\n", rebuilt,
+                               per_value / rebuilt);
+  llvm::outs() << "  update cached     "
+               << llvm::format("%8.2f ns/value, %.2fx\n", cached,
+                               per_value / cached);
+}
+
+int main(int argc, char** argv) {
+  llvm::InitLLVM init(argc, argv);
+  llvm::cl::ParseCommandLineOptions(argc, argv,
+                                    "fitx transition table benchmarks\n");
+
+  for (auto define_states : def_funcs) {
+    framework::StateManager manager;
+    define_states(manager);
+    benchmark(manager);
+  }
+  return 0;
+}
@@ -0,0 +1,180 @@
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "All_Detector.hpp"
+#include "core/Logs.hpp"
+#include "framework_ir/IRGenerator.hpp"
+#include "framework_ir/Snapshot.hpp"
+#include "frontend/Analyzer.hpp"
+#include "frontend/Daemon.hpp"
+#include "frontend/Framework.hpp"
+#include "frontend/State.hpp"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+static llvm::cl::opt<std::string> SocketPath(
+    "socket", llvm::cl::desc("Unix socket the daemon listens on"),
+    llvm::cl::init("/tmp/fitxd.sock"));
+
+static llvm::cl::opt<unsigned> Jobs(
+    "j", llvm::cl::desc("Number of requests analyzed in parallel"),
+    llvm::cl::init(std::max(1u, std::thread::hardware_concurrency())));
+
+// fitxd is not loaded into clang, so there is no detector pass to register
+std::vector<framework::FrameworkPass*> framework::FrameworkPass::passes;
+
+namespace {
+class Daemon {
+ public:
+  // The rule tables are built once and inherited by every forked request
+  Daemon() {
+    for (auto& define_states : def_funcs) {
+      framework::StateManager manager;
+      define_states(manager);
+      managers_.push_back(manager);
+    }
+    for (auto& manager : managers_)
+      detectors_[framework::daemon::detectorKey(manager)] = &manager;
+  }
+
+  bool serve(const std::string& path) {
+    int listen_fd = framework::daemon::listenSocket(path);
+    if (listen_fd < 0) {
+      llvm::errs() << "fitxd: cannot listen on " << path << "\n";
+      return false;
+    }
+
+    // At most Jobs requests are analyzed at once. The next clients wait in
+    // the listen backlog until one of them exits. SIGCHLD interrupts accept,
+    // so that the requests are reaped as they exit.
+    struct sigaction action = {};
+    action.sa_handler = [](int) {};
+    sigaction(SIGCHLD, &action, nullptr);
+
+    unsigned running = 0;
+    while (true) {
+      while (running > 0 && waitpid(-1, nullptr, WNOHANG) > 0) running--;
+      if (running >= std::max(1u, Jobs.getValue())) {
+        if (waitpid(-1, nullptr, 0) > 0) running--;
+        continue;
+      }
+
+      int fd = accept(listen_fd, nullptr, nullptr);
+      if (fd < 0) {
+        if (errno == EINTR) continue;
+        break;
+      }
+
+      // A client whose request cannot be forked sees the socket closed and
+      // analyzes the module itself
+      pid_t pid = fork();
+      if (pid == 0) {
+        close(listen_fd);
+        handleRequest(fd);
+        close(fd);
+        exit(0);
+      }
+      if (pid > 0) running++;
+      close(fd);
+    }
+
+    close(listen_fd);
+    return false;
+  }
+
+ private:
+  void handleRequest(int fd) {
+    using namespace framework::daemon;
+
+    RequestHeader header;
+    if (!readAll(fd, &header, sizeof(header)) || header.magic != kMagic ||
+        header.version != kProtocolVersion)
+      return;
+
+    std::string name(header.name_size, '\0');
+    std::string detector_list(header.detectors_size, '\0');
+    if (!readAll(fd, &name[0], name.size()) ||
+        !readAll(fd, &detector_list[0], detector_list.size()))
+      return;
+
+    std::unique_ptr<llvm::WritableMemoryBuffer> buffer =
+        llvm::WritableMemoryBuffer::getNewUninitMemBuffer(header.snapshot_size,
+                                                          name);
+    if (!buffer ||
+        !readAll(fd, buffer->getBufferStart(), buffer->getBufferSize()))
+      return;
+
+    // Only the detectors the client loaded are run
+    std::vector<framework::StateManager*> managers;
+    llvm::SmallVector<llvm::StringRef, 8> keys;
+    llvm::StringRef(detector_list).split(keys, '\n', -1, false);
+    for (auto key : keys) {
+      auto detector = detectors_.find(key.str());
+      if (detector == detectors_.end()) {
+        llvm::errs() << "fitxd: unknown detector [" << key << "], " << name
+                     << " is left to the client\n";
+        ReplyStatus status = UNKNOWN_DETECTORS;
+        writeAll(fd, &status, sizeof(status));
+        return;
+      }
+      managers.push_back(detector->second);
+    }
+    ReplyStatus status = ACCEPTED;
+    if (!writeAll(fd, &status, sizeof(status))) return;
+
+    llvm::LLVMContext context;
+    auto snapshot =
+        ir_generator::snapshot::SnapshotReader::open(std::move(buffer));
+    auto module = snapshot ? snapshot->loadModule(context) : nullptr;
+    if (!module) {
+      llvm::errs() << "fitxd: cannot load " << name << "\n";
+      return;
+    }
+
+    // Everything built for the module is freed along with its context. The
+    // framework IR is only generated again if the snapshot lacks it.
+    framework::AnalysisContext analysis_context;
+    if (!snapshot->loadFrameworkIR(*module, analysis_context))
+      ir_generator::IRGenerator::generate(*module, analysis_context);
+
+    for (auto manager : managers) {
+      std::string log;
+      framework::LoggingClient client(log);
+      framework::Analyzer analyzer(*module, *manager, client, analysis_context);
+      analyzer.analyze();
+
+      if (header.flags & NO_REPLY)
+        llvm::errs() << log;
+      else if (!writeAll(fd, log.data(), log.size()))
+        break;
+    }
+  }
+
+  std::vector<framework::StateManager> managers_;
+  std::map<std::string, framework::StateManager*> detectors_;
+};
+}  // namespace
+
+int main(int argc, char** argv) {
+  llvm::InitLLVM X(argc, argv);
+  llvm::cl::ParseCommandLineOptions(argc, argv, "FiTx analysis daemon\n");
+
+  Daemon daemon;
+  return daemon.serve(SocketPath) ? 0 : 1;
+}
@@ -0,0 +1,24 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NAME 100
+
+void release_name(char* name) {
+  free(name);
+}
+
+void drop_name(char* name) {
+  release_name(name);
+}
+
+int main() {
+  char *name = (char *) malloc(NAME);
+
+  if (name == NULL)
+    return -1;
+
+  drop_name(name);
+  printf("released");
+  free(name); // BUG: double free of `name` here
+  return 0;
+}
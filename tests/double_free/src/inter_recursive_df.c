@@ -0,0 +1,18 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+void release_name(char* name, int depth) {
+  if (depth == 0) {
+    free(name);
+    return;
+  }
+  release_name(name, depth - 1);
+}
+
+int main() {
+  char *name = (char *) malloc(100);
+
+  release_name(name, 1);
+  free(name); // BUG: double free of `name` here
+  return 0;
+}
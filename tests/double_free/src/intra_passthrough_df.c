@@ -0,0 +1,22 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char** argv) {
+  char *name = (char *) malloc(100);
+  int freed = 0;
+
+  if (argc > 1) {
+    free(name);
+    freed = 1;
+  }
+
+  switch (freed) {
+    case 0:
+      free(name);
+      break;
+    default:
+      free(name); // BUG: double free of `name` here
+      break;
+  }
+  return 0;
+}
@@ -0,0 +1,17 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char** argv) {
+  char *name = (char *) malloc(100);
+
+  if (argc > 1)
+    free(name);
+  else
+    printf("kept");
+
+  if (argc > 2)
+    printf("more");
+
+  free(name); // BUG: double free of `name` here
+  return 0;
+}
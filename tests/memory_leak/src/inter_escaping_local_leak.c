@@ -0,0 +1,20 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+struct holder {
+  int id;
+  char* name;
+};
+
+void fill(struct holder* holder) {
+  holder->name = malloc(100);
+}
+
+int main(int argc, char** argv) {
+  struct holder holder;
+
+  fill(&holder); // BUG: memory leak of `holder.name`, which is never freed
+  if (argc > 1)
+    printf("filled");
+  return 0;
+}